@@ -3,6 +3,10 @@
 
 #include "../types.h"
 #include "../attributeTypes.h"
+#include "occupancy.h"
+#include "mazejournal.h"
+#include "mazeplanes.h"
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <exception>
@@ -30,7 +34,9 @@ struct AdvancedPlayerData
     int stickyBombAvoids;
     int stickyBombs;
     AdvancedPlayerMove moveInProgress;
-    AdvancedPlayerData(uint X=0, uint Y=0, int ID=0) : x(X), y(Y), id(ID) {}
+    AdvancedPlayerData(uint X=0, uint Y=0, int ID=0) : x(X), y(Y), id(ID),
+        ticksPerTurn(0), mapVisionDist(0), playerVisionDist(0), ticksLeftForCurrentMove(0),
+        wallBreaksLeft(0), wallPhaseLeft(0), luckLeft(0), stickyBombAvoids(0), stickyBombs(0) {}
 };
 
 struct point
@@ -40,78 +46,236 @@ struct point
     bool operator ==(const point& other){return x == other.x && y == other.y;}
 };
 
-template<class Tile>
+//Shortest step from a to b on a line of size tiles, going round the end
+//when the line wraps and that way is shorter
+inline long long wrappedDelta(unsigned long long a, unsigned long long b, unsigned int size, bool wrapped)
+{
+    long long d = (long long)b - (long long)a;
+    if(wrapped)
+    {
+        if(2*d > (long long)size) d -= size;
+        else if(-2*d > (long long)size) d += size;
+    }
+    return d;
+}
+
+//Tiles are kept in Storage, a MazePlanes by default, and built when read
+//Copies share the storage, so a maze is passed around like a handle to it
+//and freed with destroy
+template<class Tile, class Storage = MazePlanes<>>
 class maze
 {
-public:
-    class iterator
+    Storage _s;
+    unsigned int _w = 0, _h = 0;
+    bool _wrapped = false;
+
+    //Width or height less one when it is a power of two, so wrapping is a mask
+    unsigned int _wMask = 0, _hMask = 0;
+    static unsigned int _maskFor(unsigned int n) {return n && (n & (n-1)) == 0 ? n-1 : 0;}
+
+    //Tile x, y built from the storage, which has to be able to read there
+    Tile _tile(unsigned int x, unsigned int y) const
+    {
+        Tile out = Tile();
+        out.exits = _s.exits(x, y);
+        out.uid = _s.uid(x, y);
+        for(unsigned int f=0; f<MAZE_FLAG_COUNT; f++)
+            MazeTileFlags<Tile>::set(out, (MazeFlag)f, _s.flag((MazeFlag)f, x, y));
+        return out;
+    }
+
+    //Makes a change to x, y through change(), journaled
+    template<class Fn>
+    void _change(unsigned int x, unsigned int y, Fn change)
     {
-        friend class maze;
-        friend std::ostream& operator<<(std::ostream& out, const typename maze<Tile>::iterator& m)
+        if(x >= _w || y >= _h) return;
+        if(!journal.recording())
         {
-            return out << m._curr;
+            change();
+            return;
         }
-        Tile* _curr;
-        
-        iterator(Tile* ptr) : _curr(ptr){};
-        public:
-            bool operator == (const iterator& other) {return _curr == other._curr;}
-            bool operator != (const iterator& other) {return _curr != other._curr;}
-
-            iterator& operator++(){_curr++; return *this;}
-            iterator& operator--(){_curr--; return *this;}
-
-            iterator operator++(int){_curr++; return iterator(_curr-1);}
-            iterator operator--(int){_curr--; return iterator(_curr+1);}
-
-            iterator operator +(unsigned int n){_curr += n; return *this;}
-            iterator operator -(unsigned int n){_curr -= n; return *this;}
-
-            iterator& operator +=(unsigned int n){_curr += n; return *this;}
-            iterator& operator -=(unsigned int n){_curr -= n; return *this;}
-
-            Tile& operator*(){return *_curr;}
-            Tile* operator->(){return _curr;}
-    };
-
-private:
-    Tile* _maze = nullptr;
-    unsigned int _w, _h;
-    bool _wrapped;
-    Tile _out_of_bounds;
+
+        Tile before = _tile(x, y);
+        change();
+        journal.record(index(x, y), before, _tile(x, y));
+    }
+
 public:
+    typedef Tile TileType;
+    typedef Storage StorageType;
+
     std::vector<point> players;
-    point exit;
+    point exit = point{0, 0};
+
+    //Players on each tile, keyed by index(x, y)
+    OccupancyIndex occupants;
+
+    //Tiles changed through the setters, for anything that follows the maze as it changes
+    MazeJournal<Tile> journal;
 
     maze(){}
-    maze(Tile* data, unsigned int width, unsigned int height, bool wrapped) : _maze(data), _w(width), _h(height), _wrapped(wrapped){}
+
+    //Every tile starts as a wall with no flags
+    maze(unsigned int width, unsigned int height, bool wrapped) : maze(Storage(width, height), width, height, wrapped){}
+
+    //A maze on storage that already holds its tiles
+    maze(const Storage& storage, unsigned int width, unsigned int height, bool wrapped) :
+        _s(storage), _w(width), _h(height), _wrapped(wrapped), _wMask(_maskFor(width)), _hMask(_maskFor(height)){}
+
     unsigned int width() const {return _w;}
     unsigned int height() const {return _h;}
     bool wrapped() const {return _wrapped;}
 
-    Tile& at(const unsigned int& x, const unsigned int& y)
+    //Where x or y is on a wrapped maze, taken round the edges
+    //Unchanged on other mazes, so off the edge stays off it
+    unsigned int wrapX(long long x) const
     {
-        if(x < 0 || x >= _w ||  y < 0 ||  y >= _h)
+        if(!_wrapped) return x;
+        if(_wMask) return x & _wMask;
+        x %= (long long)_w;
+        return x < 0 ? x + _w : x;
+    }
+
+    unsigned int wrapY(long long y) const
+    {
+        if(!_wrapped) return y;
+        if(_hMask) return y & _hMask;
+        y %= (long long)_h;
+        return y < 0 ? y + _h : y;
+    }
+
+    //Tile with no exits, for anywhere off the maze
+    //Shared and never changed, so any thread may read it
+    static const Tile& wall()
+    {
+        static const Tile out = []()
         {
-            //Reset out of bounds tile and return it
-            _out_of_bounds = Tile();
-            return _out_of_bounds;
-        }
-        return *(_maze + _w*y + x);
+            Tile t = Tile();
+            t.exits = 0;
+            return t;
+        }();
+        return out;
     }
 
-    Tile& at(const point& loc)
+    //Tiles off the maze read as wall()
+    //Unsigned, so coordinates just below 0 wrap to huge ones and are off it too
+    Tile at(const unsigned int& x, const unsigned int& y) const
+    {
+        if(x >= _w || y >= _h) return wall();
+        return _tile(x, y);
+    }
+
+    Tile at(const point& loc) const
     {
         return at(loc.x, loc.y);
     }
 
-    iterator begin() {return iterator(_maze);}
-    iterator end()  {return iterator(_maze+_w*_h+1);}
-    iterator cbegin() {return iterator(_maze+_w*_h);}
-    iterator cend() {return iterator(_maze-1);}
+    //Single fields of a tile, without building the rest of it
+    //Off the maze there are no exits and no flags
+    unsigned char exits(const unsigned int& x, const unsigned int& y) const
+    {
+        return x < _w && y < _h ? _s.exits(x, y) : 0;
+    }
+
+    unsigned char exits(const point& loc) const {return exits(loc.x, loc.y);}
+
+    bool flag(MazeFlag f, const unsigned int& x, const unsigned int& y) const
+    {
+        return x < _w && y < _h && _s.flag(f, x, y);
+    }
+
+    unsigned int uid(const unsigned int& x, const unsigned int& y) const
+    {
+        return x < _w && y < _h ? _s.uid(x, y) : 0;
+    }
+
+    //Changes to tiles, journaled. Tiles off the maze can't be changed
+    void setExits(const unsigned int& x, const unsigned int& y, unsigned char exits)
+    {
+        _change(x, y, [&](){_s.setExits(x, y, exits);});
+    }
+
+    //Opens exits on top of the ones x, y has
+    void addExits(const unsigned int& x, const unsigned int& y, unsigned char exits)
+    {
+        _change(x, y, [&](){_s.setExits(x, y, _s.exits(x, y) | exits);});
+    }
+
+    void setFlag(MazeFlag f, const unsigned int& x, const unsigned int& y, bool value)
+    {
+        _change(x, y, [&](){_s.setFlag(f, x, y, value);});
+    }
+
+    void setFlag(MazeFlag f, const point& loc, bool value) {setFlag(f, loc.x, loc.y, value);}
+
+    //Uids are settled while a maze is built, never during a game
+    //Derived ones are key's for each tile's index, see tileuids.h
+    void deriveUids(const TileUids& key) {_s.deriveUids(key);}
+    void setUid(const unsigned int& x, const unsigned int& y, unsigned int uid) {if(x < _w && y < _h) _s.setUid(x, y, uid);}
 
-    bool valid() const {return _maze != nullptr;}
-    void destroy() {delete[] _maze; _maze=nullptr;}
+    //Row major position of x, y whatever the storage, for keying things by tile
+    size_t index(const unsigned int& x, const unsigned int& y) const {return (size_t)_w*y + x;}
+
+    //Builds the width tiles from x, y rightwards into out. Tiles outside the
+    //maze are set to outside, unless the maze wraps, when the row carries on
+    //round the edges. Rows inside a guarded storage's ring are built without
+    //checking where each tile is, so the ring's walls stand in for outside
+    void readRow(long long x, long long y, unsigned int width, Tile* out, const Tile& outside) const
+    {
+        const long long guard = Storage::GUARD;
+        if(!_wrapped && guard && x >= -guard && y >= -guard && x + width <= _w + guard && y < _h + guard)
+        {
+            for(unsigned int col=0; col<width; col++)
+                out[col] = _tile(x + col, y);
+            return;
+        }
+
+        long long my = wrapY(y);
+        if(my < 0 || my >= _h)
+        {
+            std::fill(out, out + width, outside);
+            return;
+        }
+
+        for(unsigned int col=0; col<width; col++)
+        {
+            long long mx = wrapX(x + col);
+            out[col] = mx < 0 || mx >= _w ? outside : _tile(mx, my);
+        }
+    }
+
+    //The width x height window with its top left corner at x, y, one row
+    //after another, see readRow
+    void readWindow(long long x, long long y, unsigned int width, unsigned int height,
+                    Tile* out, const Tile& outside) const
+    {
+        for(unsigned int row=0; row<height; row++, out += width)
+            readRow(x, y + row, width, out, outside);
+    }
+
+    //Calls fn(x, y) for every tile, row by row
+    template<class Fn>
+    void forEachTile(Fn fn) const
+    {
+        for(unsigned int y=0; y<_h; y++)
+            for(unsigned int x=0; x<_w; x++)
+                fn(x, y);
+    }
+
+    //The storage itself, for snapshots and code that knows which it is
+    //Changes made through it aren't journaled
+    Storage& storage() {return _s;}
+    const Storage& storage() const {return _s;}
+
+    bool valid() const {return _s.valid();}
+    void destroy() {_s = Storage(); occupants.clear(); journal.restart();}
 };
 
+//Advanced tiles in 16x16 blocks of Z-ordered tiles, see BlockedLayout
+typedef maze<AdvancedMapTile, MazePlanes<BlockedLayout<4>>> BlockedAdvancedMaze;
+
+//Advanced tiles inside a ring of 32 tiles of walls, so sections read
+//without checking where their tiles are, see GuardedLayout
+typedef maze<AdvancedMapTile, MazePlanes<GuardedLayout<32>>> GuardedAdvancedMaze;
+
 #endif
@@ -0,0 +1,369 @@
+#ifndef _CHUNKED_PLANES_H
+#define _CHUNKED_PLANES_H
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "backend_types.h"
+#include "../mazerandom.h"
+
+//Maze storage generated a chunk at a time, the first time a tile in it is
+//read, see MazePlanes for what every storage has
+//Each 2^ChunkBits square chunk is a depth first maze drawn from its own
+//random stream, seeded from the maze's seed and the chunk's position, so a
+//chunk comes out the same whenever it is made. Every chunk opens one
+//passage through its east and south borders, at a row or column picked the
+//same way, so neighbours agree on where they meet without either being
+//generated. That keeps the whole maze connected.
+//Only the most recently read maxChunks chunks are kept. Walls changed since
+//generation, flags and uids set by hand are kept aside by tile index, so
+//they outlive their chunk and are all a snapshot has to save. Memory
+//follows the tiles looked at and changed, not the size of the maze
+//Reads are const and may come from any thread, the chunks kept are behind a lock
+//Unlike other storages a new one is a maze, drawn from seed 0, rather than walls
+template<unsigned int ChunkBits = 8>
+class ChunkedPlanes
+{
+public:
+    static const unsigned int GUARD = 0;
+    static const bool LAZY = true;
+    static const unsigned int SIDE = 1u << ChunkBits;
+
+    typedef std::unordered_map<size_t, unsigned char> Edits;
+    typedef std::unordered_set<size_t> FlagSet;
+    typedef std::unordered_map<size_t, uint32_t> Uids;
+
+    //What tells one maze from another drawn from the same seed
+    struct Saved
+    {
+        unsigned int width = 0, height = 0;
+        uint64_t seed = 0;
+        std::shared_ptr<const Edits> edits;
+        std::shared_ptr<const FlagSet> flags[MAZE_FLAG_COUNT];
+        std::shared_ptr<const Uids> uids;
+        TileUids key;
+    };
+
+private:
+    static const unsigned int MASK = SIDE - 1;
+
+    struct Chunk
+    {
+        std::vector<unsigned char> exits;
+        std::list<uint64_t>::iterator used;
+    };
+
+    //Copies of the storage share all of it, like copies of other storages share their planes
+    struct State
+    {
+        unsigned int w = 0, h = 0;
+        uint64_t seed = 0;
+        size_t maxChunks = 0;
+
+        std::mutex lock;
+        std::unordered_map<uint64_t, Chunk> chunks;
+        std::list<uint64_t> lru;   //Most recently used first
+        size_t generated = 0;
+
+        //Chunk read last, so runs of reads in one chunk skip the lookup
+        uint64_t lastKey = 0;
+        Chunk* last = nullptr;
+
+        Edits edits;
+        FlagSet flags[MAZE_FLAG_COUNT];
+        Uids uids;
+        TileUids key;
+
+        //Whether anything was written since the storage was last saved or
+        //restored, and whether it has been yet
+        bool editsChanged = false, flagsChanged[MAZE_FLAG_COUNT] = {}, uidsChanged = false;
+        bool tracking = false;
+    };
+    std::shared_ptr<State> _s;
+
+    static uint64_t _mix(uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ull;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBull;
+        x ^= x >> 31;
+        return x;
+    }
+
+    uint64_t _hash(unsigned int cx, unsigned int cy, unsigned int salt) const
+    {
+        return _mix(_s->seed ^ _mix(((uint64_t)cx << 32 | cy) ^ _mix(salt)));
+    }
+
+    unsigned int _chunkW(unsigned int cx) const {return std::min(SIDE, _s->w - (cx << ChunkBits));}
+    unsigned int _chunkH(unsigned int cy) const {return std::min(SIDE, _s->h - (cy << ChunkBits));}
+
+    //Row of the passage from chunk cx, cy into its east neighbour
+    unsigned int _eastDoor(unsigned int cx, unsigned int cy) const {return _hash(cx, cy, 1) % _chunkH(cy);}
+    //Column of the passage from chunk cx, cy into its south neighbour
+    unsigned int _southDoor(unsigned int cx, unsigned int cy) const {return _hash(cx, cy, 2) % _chunkW(cx);}
+
+    void _generate(unsigned int cx, unsigned int cy, std::vector<unsigned char>& exits) const
+    {
+        typedef AdvancedMapTile::Direction Dir;
+
+        unsigned int w = _chunkW(cx), h = _chunkH(cy);
+        exits.assign(SIDE*SIDE, 0);
+        std::vector<bool> seen(SIDE*SIDE, false);
+        std::vector<unsigned int> stack;
+        MazeRandom rng(_hash(cx, cy, 0), 0);
+
+        stack.push_back(0);
+        seen[0] = true;
+        while(stack.size())
+        {
+            unsigned int curr = stack.back();
+            unsigned int x = curr & MASK, y = curr >> ChunkBits;
+
+            unsigned int options[4];
+            unsigned char dirs[4];
+            unsigned int count = 0;
+            if(y > 0 && !seen[curr - SIDE]) {options[count] = curr - SIDE; dirs[count++] = (unsigned char)Dir::NORTH;}
+            if(x+1 < w && !seen[curr + 1]) {options[count] = curr + 1; dirs[count++] = (unsigned char)Dir::EAST;}
+            if(y+1 < h && !seen[curr + SIDE]) {options[count] = curr + SIDE; dirs[count++] = (unsigned char)Dir::SOUTH;}
+            if(x > 0 && !seen[curr - 1]) {options[count] = curr - 1; dirs[count++] = (unsigned char)Dir::WEST;}
+
+            if(count == 0)
+            {
+                stack.pop_back();
+                continue;
+            }
+
+            unsigned int choice = rng.below(count);
+            unsigned int next = options[choice];
+            exits[curr] |= dirs[choice];
+            //Opposite direction is two bits around
+            exits[next] |= ((dirs[choice] << 2) | (dirs[choice] >> 2)) & 0x0F;
+            seen[next] = true;
+            stack.push_back(next);
+        }
+
+        //Doors this chunk owns, and the ones its west and north neighbours own
+        unsigned int chunksWide = (_s->w + MASK) >> ChunkBits;
+        unsigned int chunksHigh = (_s->h + MASK) >> ChunkBits;
+        if(cx+1 < chunksWide)
+            exits[(_eastDoor(cx, cy) << ChunkBits) + w-1] |= (unsigned char)Dir::EAST;
+        if(cy+1 < chunksHigh)
+            exits[((h-1) << ChunkBits) + _southDoor(cx, cy)] |= (unsigned char)Dir::SOUTH;
+        if(cx > 0)
+            exits[_eastDoor(cx-1, cy) << ChunkBits] |= (unsigned char)Dir::WEST;
+        if(cy > 0)
+            exits[_southDoor(cx, cy-1)] |= (unsigned char)Dir::NORTH;
+    }
+
+    //Chunk holding x, y, generated if it isn't kept. Call with the lock held
+    const Chunk& _chunk(unsigned int x, unsigned int y) const
+    {
+        State& s = *_s;
+        unsigned int cx = x >> ChunkBits, cy = y >> ChunkBits;
+        uint64_t key = (uint64_t)cx << 32 | cy;
+        if(s.last && key == s.lastKey)
+            return *s.last;
+
+        auto found = s.chunks.find(key);
+        if(found != s.chunks.end())
+        {
+            s.lru.splice(s.lru.begin(), s.lru, found->second.used);
+            s.lastKey = key;
+            s.last = &found->second;
+            return found->second;
+        }
+
+        //The chunk thrown away may be the last one read, which is replaced below
+        if(s.maxChunks && s.chunks.size() >= s.maxChunks)
+        {
+            s.chunks.erase(s.lru.back());
+            s.lru.pop_back();
+        }
+
+        Chunk& out = s.chunks[key];
+        _generate(cx, cy, out.exits);
+        s.lru.push_front(key);
+        out.used = s.lru.begin();
+        s.generated++;
+
+        s.lastKey = key;
+        s.last = &out;
+        return out;
+    }
+
+    //Forgets every chunk kept, for a new seed
+    void _clearChunks()
+    {
+        std::lock_guard<std::mutex> hold(_s->lock);
+        _s->chunks.clear();
+        _s->lru.clear();
+        _s->last = nullptr;
+    }
+
+    size_t _index(unsigned int x, unsigned int y) const {return (size_t)_s->w*y + x;}
+
+    bool _matches(const Saved* base) const {return base && _s->tracking && base->seed == _s->seed;}
+
+public:
+    ChunkedPlanes(){}
+
+    ChunkedPlanes(unsigned int width, unsigned int height) : _s(std::make_shared<State>())
+    {
+        _s->w = width;
+        _s->h = height;
+        _s->seed = _mix(0);
+    }
+
+    //Draws the maze from seed, forgetting every change made to it
+    //maxChunks is how many chunks may be kept at once, 0 for no limit
+    void generate(uint64_t seed, size_t maxChunks)
+    {
+        _clearChunks();
+        _s->seed = _mix(seed);
+        _s->maxChunks = maxChunks;
+        _s->edits.clear();
+        for(FlagSet& f : _s->flags) f.clear();
+        _s->uids.clear();
+        _s->tracking = false;
+    }
+
+    bool valid() const {return _s != nullptr;}
+
+    unsigned char exits(unsigned int x, unsigned int y) const
+    {
+        if(_s->edits.size())
+        {
+            auto found = _s->edits.find(_index(x, y));
+            if(found != _s->edits.end()) return found->second;
+        }
+
+        std::lock_guard<std::mutex> hold(_s->lock);
+        return _chunk(x, y).exits[((y & MASK) << ChunkBits) | (x & MASK)];
+    }
+
+    void setExits(unsigned int x, unsigned int y, unsigned char exits)
+    {
+        _s->edits[_index(x, y)] = exits;
+        _s->editsChanged = true;
+    }
+
+    bool flag(MazeFlag f, unsigned int x, unsigned int y) const
+    {
+        return _s->flags[f].size() && _s->flags[f].count(_index(x, y));
+    }
+
+    void setFlag(MazeFlag f, unsigned int x, unsigned int y, bool value)
+    {
+        if(value) _s->flags[f].insert(_index(x, y));
+        else _s->flags[f].erase(_index(x, y));
+        _s->flagsChanged[f] = true;
+    }
+
+    uint32_t uid(unsigned int x, unsigned int y) const
+    {
+        if(x >= _s->w || y >= _s->h) return 0;
+        size_t i = _index(x, y);
+        if(_s->uids.size())
+        {
+            auto found = _s->uids.find(i);
+            if(found != _s->uids.end()) return found->second;
+        }
+        return _s->key(i);
+    }
+
+    void deriveUids(const TileUids& key)
+    {
+        _s->key = key;
+        _s->uids.clear();
+        _s->uidsChanged = true;
+    }
+
+    void setUid(unsigned int x, unsigned int y, uint32_t uid)
+    {
+        _s->uids[_index(x, y)] = uid;
+        _s->uidsChanged = true;
+    }
+
+    Saved save(const Saved* base)
+    {
+        State& s = *_s;
+        Saved out;
+        out.width = s.w;
+        out.height = s.h;
+        out.seed = s.seed;
+        out.key = s.key;
+
+        bool matches = _matches(base);
+        out.edits = matches && !s.editsChanged ? base->edits : std::make_shared<const Edits>(s.edits);
+        out.uids = matches && !s.uidsChanged ? base->uids : std::make_shared<const Uids>(s.uids);
+        for(unsigned int f=0; f<MAZE_FLAG_COUNT; f++)
+        {
+            out.flags[f] = matches && !s.flagsChanged[f] ? base->flags[f] : std::make_shared<const FlagSet>(s.flags[f]);
+            s.flagsChanged[f] = false;
+        }
+
+        s.editsChanged = s.uidsChanged = false;
+        s.tracking = true;
+        return out;
+    }
+
+    //Keeps the chunks already made when the seed is the same
+    void restore(const Saved& saved, const Saved* base)
+    {
+        State& s = *_s;
+        bool matches = _matches(base);
+        if(saved.seed != s.seed)
+        {
+            _clearChunks();
+            s.seed = saved.seed;
+        }
+
+        if(!matches || s.editsChanged || base->edits != saved.edits) s.edits = *saved.edits;
+        if(!matches || s.uidsChanged || base->uids != saved.uids) s.uids = *saved.uids;
+        for(unsigned int f=0; f<MAZE_FLAG_COUNT; f++)
+        {
+            if(!matches || s.flagsChanged[f] || base->flags[f] != saved.flags[f]) s.flags[f] = *saved.flags[f];
+            s.flagsChanged[f] = false;
+        }
+        s.key = saved.key;
+
+        s.editsChanged = s.uidsChanged = false;
+        s.tracking = true;
+    }
+
+    size_t residentChunks() const
+    {
+        std::lock_guard<std::mutex> hold(_s->lock);
+        return _s->chunks.size();
+    }
+
+    //Chunks generated so far, counting ones made again after being thrown away
+    size_t generatedChunks() const
+    {
+        std::lock_guard<std::mutex> hold(_s->lock);
+        return _s->generated;
+    }
+
+    //Bytes the kept chunks and the changes take up, roughly for the changes
+    size_t memoryBytes() const
+    {
+        size_t out = residentChunks()*(SIDE*SIDE + sizeof(Chunk));
+        out += _s->edits.size()*(sizeof(size_t) + 2*sizeof(void*));
+        for(const FlagSet& f : _s->flags)
+            out += f.size()*(sizeof(size_t) + 2*sizeof(void*));
+        return out;
+    }
+};
+
+//Advanced tiles generated as they are looked at, see ChunkedGenerator
+typedef maze<AdvancedMapTile, ChunkedPlanes<>> ChunkedAdvancedMaze;
+
+#endif
@@ -0,0 +1,408 @@
+#ifndef _MAZE_BITS_H
+#define _MAZE_BITS_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "backend_types.h"
+#include "../mazerandom.h"
+
+//Which walls of a maze are open, one bit per tile, 64 tiles to a word
+//Each row starts on a new word. A tile's east bit is set when it and its
+//east neighbour both have an exit towards each other, and its south bit the
+//same going south. West and north are the east and south bits of the tile
+//on that side, so two planes hold every passage
+class MazeBits
+{
+    unsigned int _w = 0, _h = 0, _words = 0;
+    bool _wrapped = false;
+    std::vector<uint64_t> _east, _south;
+
+    static void _put(uint64_t* row, unsigned int x, bool value)
+    {
+        uint64_t bit = 1ull << (x%64);
+        row[x/64] = value ? row[x/64] | bit : row[x/64] & ~bit;
+    }
+
+    //Whether tile exits a, and b east or south of it, open onto each other
+    static bool _opensEast(unsigned char a, unsigned char b)
+    {
+        return (a & (unsigned char)AdvancedMapTile::Direction::EAST) && (b & (unsigned char)AdvancedMapTile::Direction::WEST);
+    }
+
+    static bool _opensSouth(unsigned char a, unsigned char b)
+    {
+        return (a & (unsigned char)AdvancedMapTile::Direction::SOUTH) && (b & (unsigned char)AdvancedMapTile::Direction::NORTH);
+    }
+
+public:
+    MazeBits(){}
+
+    //Works from anything with exits(x, y), such as a maze<Tile>
+    template<class Maze>
+    MazeBits(Maze& m) : _w(m.width()), _h(m.height()), _words((m.width() + 63)/64), _wrapped(m.wrapped()),
+        _east((size_t)_words*_h, 0), _south((size_t)_words*_h, 0)
+    {
+        //Two rows of exits at a time, so each tile is only fetched once
+        std::vector<unsigned char> row(_w), below(_w), first(_w);
+        for(unsigned int x=0; x<_w; x++)
+            first[x] = row[x] = m.exits(x, 0);
+
+        for(unsigned int y=0; y<_h; y++)
+        {
+            bool last = y+1 == _h;
+            if(!last)
+                for(unsigned int x=0; x<_w; x++)
+                    below[x] = m.exits(x, y+1);
+            else if(_wrapped)
+                below = first;
+
+            uint64_t* east = &_east[(size_t)_words*y];
+            uint64_t* south = &_south[(size_t)_words*y];
+            for(unsigned int x=0; x<_w; x++)
+            {
+                unsigned int next = x+1 < _w ? x+1 : 0;
+                bool e = _opensEast(row[x], row[next]) && (x+1 < _w || _wrapped);
+                bool s = _opensSouth(row[x], below[x]) && (!last || _wrapped);
+                east[x/64] |= (uint64_t)e << (x%64);
+                south[x/64] |= (uint64_t)s << (x%64);
+            }
+            row.swap(below);
+        }
+    }
+
+    //Brings the walls round x, y up to date after the tile changed in m
+    template<class Maze>
+    void update(Maze& m, unsigned int x, unsigned int y)
+    {
+        unsigned int west = x > 0 ? x-1 : _w-1, east = x+1 < _w ? x+1 : 0;
+        unsigned int north = y > 0 ? y-1 : _h-1, south = y+1 < _h ? y+1 : 0;
+        unsigned char here = m.exits(x, y);
+
+        _put(&_east[(size_t)_words*y], x, (x+1 < _w || _wrapped) && _opensEast(here, m.exits(east, y)));
+        _put(&_south[(size_t)_words*y], x, (y+1 < _h || _wrapped) && _opensSouth(here, m.exits(x, south)));
+        if(x > 0 || _wrapped)
+            _put(&_east[(size_t)_words*y], west, _opensEast(m.exits(west, y), here));
+        if(y > 0 || _wrapped)
+            _put(&_south[(size_t)_words*north], x, _opensSouth(m.exits(x, north), here));
+    }
+
+    unsigned int width() const {return _w;}
+    unsigned int height() const {return _h;}
+    bool wrapped() const {return _wrapped;}
+
+    //Words in each row
+    unsigned int words() const {return _words;}
+
+    const uint64_t* eastRow(unsigned int y) const {return &_east[(size_t)_words*y];}
+    const uint64_t* southRow(unsigned int y) const {return &_south[(size_t)_words*y];}
+
+    bool east(unsigned int x, unsigned int y) const {return eastRow(y)[x/64] >> (x%64) & 1;}
+    bool south(unsigned int x, unsigned int y) const {return southRow(y)[x/64] >> (x%64) & 1;}
+};
+
+//Breadth first search over a MazeBits, a whole layer at a time
+//The front is the layer of tiles just reached. Each step moves every bit of
+//it through the open walls with shifts and ands, 64 tiles at once, and keeps
+//what wasn't reached before as the next front. Only the words the front is
+//in are looked at, so a thin front in a long maze stays cheap
+class MazeFlood
+{
+    const MazeBits* _bits = nullptr;
+    unsigned int _depth = 0;
+
+    std::vector<uint64_t> _seen, _front, _next;
+
+    //Words of _front and _next that aren't 0, by index
+    std::vector<size_t> _active, _nextActive;
+
+    //Words of _seen that aren't 0, so starting again only clears what the
+    //last flood reached instead of the whole maze
+    std::vector<size_t> _touched;
+
+    void _add(size_t word, uint64_t bits)
+    {
+        bits &= ~_seen[word];
+        if(!bits) return;
+        if(!_next[word]) _nextActive.push_back(word);
+        _next[word] |= bits;
+    }
+
+public:
+    MazeFlood(){}
+
+    MazeFlood(const MazeBits& bits) : _bits(&bits)
+    {
+        size_t words = (size_t)bits.words()*bits.height();
+        _seen.assign(words, 0);
+        _front.assign(words, 0);
+        _next.assign(words, 0);
+    }
+
+    //Starts again with only x, y reached
+    void start(unsigned int x, unsigned int y)
+    {
+        for(size_t i : _touched) _seen[i] = 0;
+        for(size_t i : _active) _front[i] = 0;
+        _touched.clear();
+        _active.clear();
+        _depth = 0;
+
+        size_t word = (size_t)_bits->words()*y + x/64;
+        _seen[word] = _front[word] = 1ull << (x%64);
+        _active.push_back(word);
+        _touched.push_back(word);
+    }
+
+    //Moves the front on a layer. Returns false once there is nothing new to reach
+    bool step()
+    {
+        const unsigned int words = _bits->words(), h = _bits->height(), w = _bits->width();
+        const bool wrapped = _bits->wrapped();
+        const unsigned int lastWord = (w - 1)/64, lastBit = (w - 1)%64;
+
+        for(size_t i : _active)
+        {
+            uint64_t f = _front[i];
+            unsigned int y = i/words, k = i%words;
+            const uint64_t* east = _bits->eastRow(y);
+            const uint64_t* south = _bits->southRow(y);
+            size_t rowStart = i - k;
+
+            //East, carrying the top bit into the next word
+            //The row's last tile only goes east round the end, below
+            uint64_t e = f & east[k];
+            if(k == lastWord) e &= ~(1ull << lastBit);
+            _add(i, e << 1);
+            if(k < lastWord) _add(i+1, e >> 63);
+
+            //West, through the east wall of the tile moved onto
+            _add(i, (f >> 1) & east[k]);
+            if(k > 0) _add(i-1, (f << 63) & east[k-1]);
+
+            //Round the ends of the row
+            if(wrapped && k == lastWord && (f >> lastBit & 1) && (east[lastWord] >> lastBit & 1))
+                _add(rowStart, 1);
+            if(wrapped && k == 0 && (f & 1) && (east[lastWord] >> lastBit & 1))
+                _add(rowStart + lastWord, 1ull << lastBit);
+
+            //South through this row's south walls, north through the row above's
+            if(y+1 < h) _add(i + words, f & south[k]);
+            else if(wrapped) _add(k, f & south[k]);
+
+            if(y > 0) _add(i - words, f & _bits->southRow(y-1)[k]);
+            else if(wrapped) _add((size_t)(h-1)*words + k, f & _bits->southRow(h-1)[k]);
+        }
+
+        for(size_t i : _active) _front[i] = 0;
+        for(size_t i : _nextActive)
+        {
+            if(!_seen[i]) _touched.push_back(i);
+            _seen[i] |= _next[i];
+        }
+        _front.swap(_next);
+        _active.swap(_nextActive);
+        _nextActive.clear();
+
+        if(_active.empty()) return false;
+        _depth++;
+        return true;
+    }
+
+    //Steps taken from the start to the front
+    unsigned int depth() const {return _depth;}
+
+    bool inFront(unsigned int x, unsigned int y) const
+    {
+        return _front[(size_t)_bits->words()*y + x/64] >> (x%64) & 1;
+    }
+
+    bool reached(unsigned int x, unsigned int y) const
+    {
+        return _seen[(size_t)_bits->words()*y + x/64] >> (x%64) & 1;
+    }
+
+    size_t frontSize() const
+    {
+        size_t out = 0;
+        for(size_t i : _active) out += __builtin_popcountll(_front[i]);
+        return out;
+    }
+
+    //Calls fn(x, y) for every tile in the front, in no particular order
+    template<class Fn>
+    void forEachInFront(Fn fn) const
+    {
+        const unsigned int words = _bits->words();
+        for(size_t i : _active)
+        {
+            for(uint64_t f = _front[i]; f; f &= f - 1)
+                fn((unsigned int)(i%words*64 + __builtin_ctzll(f)), (unsigned int)(i/words));
+        }
+    }
+};
+
+//Breadth first search from one tile over anything with exits(x, y), going
+//through each tile's own exits, for mazes whose walls always match on both
+//sides. Uses one flat queue that is never popped from, so once done order
+//holds the row major index of every reached tile in the order they were
+//reached and each layer is one run of it. layerSize counts the tiles at
+//each distance
+template<class Maze>
+void flatLayers(const Maze& m, const point& from, std::vector<unsigned int>& order, std::vector<size_t>& layerSize)
+{
+    const unsigned int UNSEEN = ~0u;
+    const unsigned int w = m.width(), h = m.height();
+    std::vector<unsigned int> distance((size_t)w*h, UNSEEN);
+    order.clear();
+    layerSize.clear();
+    order.reserve(distance.size());
+    order.push_back((size_t)w*from.y + from.x);
+    distance[order[0]] = 0;
+
+    const int steps[4][3] = {
+        {(int)AdvancedMapTile::Direction::NORTH, 0, -1},
+        {(int)AdvancedMapTile::Direction::SOUTH, 0, 1},
+        {(int)AdvancedMapTile::Direction::EAST, 1, 0},
+        {(int)AdvancedMapTile::Direction::WEST, -1, 0}};
+    for(size_t i=0; i<order.size(); i++)
+    {
+        unsigned int tile = order[i];
+        unsigned int depth = distance[tile];
+        if(depth == layerSize.size()) layerSize.push_back(0);
+        layerSize[depth]++;
+
+        unsigned int x = tile % w, y = tile / w;
+        unsigned char curr = m.exits(x, y);
+        for(const int* s : steps)
+        {
+            if(!(curr & s[0])) continue;
+            long long nx = (long long)x + s[1], ny = (long long)y + s[2];
+            if(m.wrapped())
+            {
+                nx = (nx + w) % w;
+                ny = (ny + h) % h;
+            }
+            else if(nx < 0 || ny < 0 || nx >= w || ny >= h)
+                continue;
+
+            size_t at = (size_t)w*ny + nx;
+            if(distance[at] == UNSEEN)
+            {
+                distance[at] = depth + 1;
+                order.push_back(at);
+            }
+        }
+    }
+}
+
+//Layer of a search from the exit to start players on, given how many tiles
+//each layer holds. Picks a random one out of the further half of the layers
+//holding at least players tiles, or the furthest layer if none do
+inline unsigned int startLayer(const std::vector<size_t>& layerSize, unsigned int players, MazeRandom& rng)
+{
+    std::vector<unsigned int> startLayers;
+    for(unsigned int d=0; d<layerSize.size(); d++)
+        if(layerSize[d] >= players) startLayers.push_back(d);
+
+    if(startLayers.size() > 1)
+        return startLayers[rng.below(startLayers.size()/2) + startLayers.size()/2];
+    else if(startLayers.size() == 1)
+        return startLayers[0];
+    return layerSize.size() - 1;
+}
+
+//Tiles to start players on, all the same distance from the exit
+inline std::vector<point> farStartLayer(const MazeBits& bits, const point& exit, unsigned int players, MazeRandom& rng)
+{
+    MazeFlood flood(bits);
+    std::vector<size_t> layerSize;
+    flood.start(exit.x, exit.y);
+    do
+    {
+        layerSize.push_back(flood.frontSize());
+    }while(flood.step());
+
+    unsigned int layer = startLayer(layerSize, players, rng);
+
+    std::vector<point> out;
+    flood.start(exit.x, exit.y);
+    while(flood.depth() < layer && flood.step());
+    flood.forEachInFront([&out](unsigned int x, unsigned int y){out.push_back(point{x, y});});
+    return out;
+}
+
+//Breadth first search like flatLayers for mazes too big to walk whole, or
+//to hold a distance for every tile. Distances are kept by index() for only
+//the tiles reached, and the search stops at the end of a layer once limit
+//tiles are reached, or once until is if it is given. order holds the tiles
+//a layer at a time, layerSize how many each layer has
+template<class Maze>
+void nearLayers(const Maze& m, const point& from, size_t limit, const point* until,
+                std::unordered_map<size_t, unsigned int>& distance, std::vector<point>& order, std::vector<size_t>& layerSize)
+{
+    distance.clear();
+    order.clear();
+    layerSize.clear();
+    order.push_back(from);
+    distance[m.index(from.x, from.y)] = 0;
+
+    const int steps[4][3] = {
+        {(int)AdvancedMapTile::Direction::NORTH, 0, -1},
+        {(int)AdvancedMapTile::Direction::SOUTH, 0, 1},
+        {(int)AdvancedMapTile::Direction::EAST, 1, 0},
+        {(int)AdvancedMapTile::Direction::WEST, -1, 0}};
+    for(size_t i=0; i<order.size(); i++)
+    {
+        point p = order[i];
+        unsigned int depth = distance[m.index(p.x, p.y)];
+        if(depth == layerSize.size())
+        {
+            //Every tile of the layer before this one has been added
+            if(order.size() >= limit) break;
+            if(until && distance.count(m.index(until->x, until->y))) break;
+            layerSize.push_back(0);
+        }
+        layerSize[depth]++;
+
+        unsigned char curr = m.exits(p.x, p.y);
+        for(const int* s : steps)
+        {
+            if(!(curr & s[0])) continue;
+            long long nx = (long long)p.x + s[1], ny = (long long)p.y + s[2];
+            if(m.wrapped())
+            {
+                nx = m.wrapX(nx);
+                ny = m.wrapY(ny);
+            }
+            else if(nx < 0 || ny < 0 || nx >= m.width() || ny >= m.height())
+                continue;
+
+            if(distance.emplace(m.index(nx, ny), depth + 1).second)
+                order.push_back(point{(unsigned long long)nx, (unsigned long long)ny});
+        }
+    }
+
+    //Tiles of the layer the search stopped at were all found, but not counted
+    size_t counted = 0;
+    for(size_t n : layerSize) counted += n;
+    if(counted < order.size()) layerSize.push_back(order.size() - counted);
+}
+
+//Same as farStartLayer, out of the layers nearLayers reaches within limit tiles
+template<class Maze>
+std::vector<point> nearStartLayer(const Maze& m, const point& exit, unsigned int players, size_t limit, MazeRandom& rng)
+{
+    std::unordered_map<size_t, unsigned int> distance;
+    std::vector<point> order;
+    std::vector<size_t> layerSize;
+    nearLayers(m, exit, limit, nullptr, distance, order, layerSize);
+
+    unsigned int layer = startLayer(layerSize, players, rng);
+    size_t first = 0;
+    for(unsigned int d=0; d<layer; d++) first += layerSize[d];
+    return std::vector<point>(order.begin() + first, order.begin() + first + layerSize[layer]);
+}
+
+#endif
@@ -2,11 +2,13 @@
 #define _MAZEGENERATOR_H
 
 #include "backend_types.h"
+#include "../mazerandom.h"
 
 #include <vector>
 #include <utility>
 
-template<class Tile>
+//Maze is what the generator builds, maze<Tile> unless a storage is picked
+template<class Tile, class Maze = maze<Tile>>
 class MazeGenerator
 {
 public:
@@ -14,11 +16,30 @@ public:
      *  Allocates a new maze array and generates a maze
      *
      *  players - Number of players to find starts for
+     *  rng - Random stream to draw from. Generators must not use rand() so the
+     *      same stream always produces the same maze
      */
-    virtual maze<Tile> generateMaze(unsigned int players) = 0;
+    virtual Maze generateMaze(unsigned int players, MazeRandom& rng) = 0;
 
     //Returns whether or not the maze wraps around on the edges
     virtual bool isWrapped() = 0;  
 };
 
+//Draws a start for each player from candidates, using every candidate once
+//before any is used again. No starts without candidates
+inline std::vector<point> pickStarts(const std::vector<point>& candidates, unsigned int players, MazeRandom& rng)
+{
+    std::vector<point> out, left;
+    if(candidates.empty()) return out;
+
+    for(unsigned int i=0; i<players; i++)
+    {
+        if(left.size() == 0) left = candidates;
+        unsigned int pick = rng.below(left.size());
+        out.push_back(left[pick]);
+        left.erase(left.begin() + pick);
+    }
+    return out;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,149 @@
+#ifndef _MAZE_JOURNAL_H
+#define _MAZE_JOURNAL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//One tile changed through maze's setters
+template<class Tile>
+struct MazeChange
+{
+    size_t tile;            //Row major index, see maze::index
+    unsigned int tick;      //Tick the change was made on
+    Tile before, after;
+};
+
+//Changes made to a maze, in the order they were made, so anything keeping
+//its own copy of the maze can catch up with the changes since it last
+//looked instead of comparing every tile
+//Each consumer subscribes for a cursor and reads from it, which moves the
+//cursor to the end. Changes every cursor has read are thrown away, and
+//nothing is recorded while there are no cursors
+//Changes that leave the tile as it was are dropped
+template<class Tile>
+class MazeJournal
+{
+public:
+    struct Cursor
+    {
+        uint64_t journal;       //0 for a cursor that was never subscribed
+        unsigned int slot;
+
+        Cursor(uint64_t j = 0, unsigned int s = 0) : journal(j), slot(s){}
+    };
+
+private:
+    enum : size_t {FREE = ~(size_t)0};
+
+    uint64_t _id;
+    unsigned int _tick = 0;
+
+    std::vector<MazeChange<Tile>> _changes;
+    size_t _first = 0;              //Position of _changes[0] since the journal started
+
+    std::vector<size_t> _cursors;   //Position each cursor has read to, FREE for unused slots
+    unsigned int _subscribed = 0;
+
+    static uint64_t _newId()
+    {
+        static std::atomic<uint64_t> last(0);
+        return ++last;
+    }
+
+    //Drops changes every cursor has read once they are half the journal
+    void _compact()
+    {
+        size_t slowest = _first + _changes.size();
+        for(size_t at : _cursors)
+            if(at != FREE) slowest = std::min(slowest, at);
+
+        size_t read = slowest - _first;
+        if(read == 0 || read*2 < _changes.size()) return;
+        _changes.erase(_changes.begin(), _changes.begin() + read);
+        _first = slowest;
+    }
+
+public:
+    MazeJournal() : _id(_newId()){}
+
+    bool recording() const {return _subscribed > 0;}
+
+    //Tick changes from now on are recorded against
+    void setTick(unsigned int tick) {_tick = tick;}
+
+    //Records that the tile at index went from before to after
+    void record(size_t index, Tile before, Tile after)
+    {
+        if(!recording() || !(after != before)) return;
+        _changes.push_back(MazeChange<Tile>{index, _tick, before, after});
+    }
+
+    //New cursor at the end of the journal, so it sees changes from now on
+    Cursor subscribe()
+    {
+        size_t end = _first + _changes.size();
+        unsigned int slot = std::find(_cursors.begin(), _cursors.end(), (size_t)FREE) - _cursors.begin();
+        if(slot == _cursors.size()) _cursors.push_back(end);
+        else _cursors[slot] = end;
+        _subscribed++;
+        return Cursor{_id, slot};
+    }
+
+    void unsubscribe(const Cursor& c)
+    {
+        if(!valid(c)) return;
+        _cursors[c.slot] = FREE;
+        _subscribed--;
+        _compact();
+    }
+
+    //Whether c came from this journal since it last restarted
+    //Cursors stop being valid when the maze is replaced or restored, and
+    //their consumer has to look at the whole maze again
+    bool valid(const Cursor& c) const
+    {
+        return c.journal == _id && c.slot < _cursors.size() && _cursors[c.slot] != FREE;
+    }
+
+    //Changes c hasn't read yet
+    size_t pending(const Cursor& c)
+    {
+        if(!valid(c)) return 0;
+        return _first + _changes.size() - _cursors[c.slot];
+    }
+
+    //Calls fn(change) for every change since c last read, oldest first,
+    //and moves c to the end. Returns false if c isn't valid
+    template<class Fn>
+    bool read(const Cursor& c, Fn fn)
+    {
+        if(!valid(c)) return false;
+
+        size_t& at = _cursors[c.slot];
+        for(size_t i = at - _first; i < _changes.size(); i++)
+            fn((const MazeChange<Tile>&)_changes[i]);
+        at = _first + _changes.size();
+
+        _compact();
+        return true;
+    }
+
+    //Changes kept for cursors that haven't read them
+    size_t size() const {return _changes.size();}
+
+    //Forgets every change and cursor, for when the maze's tiles were
+    //replaced without going through the setters
+    void restart()
+    {
+        _id = _newId();
+        _changes.clear();
+        _first = 0;
+        _cursors.clear();
+        _subscribed = 0;
+    }
+};
+
+#endif
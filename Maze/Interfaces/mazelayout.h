@@ -0,0 +1,90 @@
+#ifndef _MAZE_LAYOUT_H
+#define _MAZE_LAYOUT_H
+
+#include <cstddef>
+
+//How a maze's tiles are arranged in the planes of a MazePlanes
+//A layout maps x, y to an offset in each plane, and says how many tiles
+//it needs, which is more than width*height when it pads. Every layout has:
+//  size()          tiles to allocate
+//  offset(x, y)    where tile x, y lives
+//  GUARD           how many tiles of walls surround the maze, see GuardedLayout
+
+//One row after another
+class RowMajorLayout
+{
+    unsigned int _w = 0, _h = 0;
+
+public:
+    static const unsigned int GUARD = 0;
+
+    RowMajorLayout(){}
+    RowMajorLayout(unsigned int width, unsigned int height) : _w(width), _h(height){}
+
+    size_t size() const {return (size_t)_w*_h;}
+    size_t offset(unsigned int x, unsigned int y) const {return (size_t)_w*y + x;}
+};
+
+//Square blocks 2^BlockBits tiles a side, each block stored whole with its
+//tiles in Z-order, so every 2x2, 4x4, 8x8... square inside it is contiguous
+//A vision window or a search front stays inside a few blocks, so it reads a
+//few contiguous pieces of memory instead of one per maze row. Blocks are in
+//row order, so the padding is less than a block on the right and bottom edges
+//rather than up to a power of two square
+template<unsigned int BlockBits>
+class BlockedLayout
+{
+    static_assert(BlockBits <= 8, "Blocks are at most 256 tiles a side");
+
+    static const unsigned int SIDE = 1u << BlockBits;
+    static const unsigned int MASK = SIDE - 1;
+
+    size_t _blocksWide = 0, _blocksHigh = 0;
+
+    //The low 8 bits of v moved to the even bits
+    static size_t _spread(size_t v)
+    {
+        v = (v | (v << 4)) & 0x0F0F;
+        v = (v | (v << 2)) & 0x3333;
+        return (v | (v << 1)) & 0x5555;
+    }
+
+public:
+    static const unsigned int GUARD = 0;
+
+    BlockedLayout(){}
+    BlockedLayout(unsigned int width, unsigned int height) :
+        _blocksWide((width + MASK) >> BlockBits), _blocksHigh((height + MASK) >> BlockBits){}
+
+    size_t size() const {return (_blocksWide*_blocksHigh) << (2*BlockBits);}
+
+    size_t offset(unsigned int x, unsigned int y) const
+    {
+        size_t block = (y >> BlockBits)*_blocksWide + (x >> BlockBits);
+        return (block << (2*BlockBits)) | (_spread(y & MASK) << 1) | _spread(x & MASK);
+    }
+};
+
+//Rows one after another inside a ring of Guard tiles on every side
+//The ring holds tiles with no exits, so anything reading up to Guard tiles
+//past the edge gets a wall without checking where it is. Make Guard at least
+//the widest vision radius and no section checks where its tiles are.
+//Offsets are worked out in unsigned arithmetic, so x or y a little below 0
+//wraps round to the left or top of the ring
+template<unsigned int Guard>
+class GuardedLayout
+{
+    size_t _stride = 0, _rows = 0;
+
+public:
+    static const unsigned int GUARD = Guard;
+
+    GuardedLayout(){}
+    GuardedLayout(unsigned int width, unsigned int height) :
+        _stride((size_t)width + 2*Guard), _rows((size_t)height + 2*Guard){}
+
+    size_t size() const {return _stride*_rows;}
+    size_t offset(unsigned int x, unsigned int y) const {return (size_t)(y + Guard)*_stride + (x + Guard);}
+};
+
+#endif
@@ -4,7 +4,7 @@
 #include "../types.h"
 #include "backend_types.h"
 
-template<class PlayerDataType, class Tile>
+template<class PlayerDataType, class Tile, class Maze = maze<Tile>>
 class MazePartitioner
 {
 public:
@@ -25,7 +25,7 @@ public:
      */
     virtual Tile* getMazeSection(unsigned int& width, unsigned int& height,
                             PlayerDataType& playerData, point& relative_loc,
-                            maze<Tile>& m) = 0;
+                            Maze& m) = 0;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,275 @@
+#ifndef _MAZE_PLANES_H
+#define _MAZE_PLANES_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "../attributeTypes.h"
+#include "mazelayout.h"
+#include "tileuids.h"
+
+//Tiles per change tracking chunk, see MazePlanes::save
+const unsigned int MAZE_CHUNK_TILES = 1024;
+
+//Tile flags kept as bitplanes by MazePlanes
+enum MazeFlag
+{
+    MAZE_FLAG_EXIT = 0,
+    MAZE_FLAG_STICKY_BOMB,
+    MAZE_FLAG_COUNT
+};
+
+//How a tile type splits into planes
+//Tiles without sticky bombs only use the exit flag
+template<class Tile>
+struct MazeTileFlags
+{
+    static bool get(const Tile& t, MazeFlag f) {return f == MAZE_FLAG_EXIT && t.isExit;}
+    static void set(Tile& t, MazeFlag f, bool value) {if(f == MAZE_FLAG_EXIT) t.isExit = value;}
+};
+
+template<>
+struct MazeTileFlags<AdvancedMapTile>
+{
+    static bool get(const AdvancedMapTile& t, MazeFlag f)
+    {
+        return f == MAZE_FLAG_EXIT ? t.isExit : t.hasStickyBomb;
+    }
+
+    static void set(AdvancedMapTile& t, MazeFlag f, bool value)
+    {
+        if(f == MAZE_FLAG_EXIT) t.isExit = value;
+        else t.hasStickyBomb = value;
+    }
+};
+
+//One plane of values and whatever keeps its memory alive
+//Copies share the memory
+template<class T>
+struct MazePlane
+{
+    T* data = nullptr;
+    std::shared_ptr<void> owner;
+
+    //n zeroed values. calloc hands big planes to the kernel a page at a
+    //time, so pages nothing writes to are never touched
+    static MazePlane allocate(size_t n)
+    {
+        MazePlane out;
+        out.data = (T*)std::calloc(n ? n : 1, sizeof(T));
+        if(!out.data) throw std::bad_alloc();
+        out.owner = std::shared_ptr<void>(out.data, std::free);
+        return out;
+    }
+};
+
+//Tiles of a maze<Tile> as a structure of arrays
+//Each tile field gets its own plane: one byte of exits per tile and one bit
+//per tile for each flag, arranged by Layout. Uids are worked out from a
+//TileUids key instead of stored, unless setUid gives the maze a plane of them
+//Copies share the planes, like copies of a maze did its tiles
+//
+//Every maze storage has:
+//  Storage(width, height)      every tile a wall with no flags
+//  valid()                     false for a default constructed one
+//  exits(x, y), flag(f, x, y), uid(x, y)
+//                              reads, only for x, y on the maze or up to
+//                              GUARD tiles off it
+//  setExits, setFlag           writes, for x, y on the maze
+//  deriveUids(key), setUid     where uids come from
+//  save(base), restore(s, base)
+//                              copies of the walls and flags to put back,
+//                              sharing what hasn't changed since base
+//  GUARD                       tiles of walls round the maze reads may reach
+//  LAZY                        whether tiles are only made when read, so
+//                              walking the whole maze is out of the question
+template<class Layout = RowMajorLayout>
+class MazePlanes
+{
+public:
+    static const unsigned int GUARD = Layout::GUARD;
+    static const bool LAZY = false;
+
+    //MAZE_CHUNK_TILES tiles of exits and flags, by offset in the layout
+    struct Chunk
+    {
+        unsigned char exits[MAZE_CHUNK_TILES];
+        uint64_t flags[MAZE_FLAG_COUNT][MAZE_CHUNK_TILES/64];
+    };
+
+    //Read only copy of the planes. Chunks are shared between every copy
+    //with the same tiles in them, and uids are shared with the maze
+    struct Saved
+    {
+        unsigned int width = 0, height = 0;
+        std::vector<std::shared_ptr<const Chunk>> chunks;
+        MazePlane<uint32_t> uids;
+        TileUids key;
+    };
+
+private:
+    unsigned int _w = 0, _h = 0;
+    Layout _layout;
+    size_t _chunks = 0;
+
+    MazePlane<unsigned char> _exits;
+    MazePlane<uint64_t> _flags[MAZE_FLAG_COUNT];
+
+    //Row major, nullptr when uids come from _key
+    MazePlane<uint32_t> _uids;
+    TileUids _key;
+
+    //One flag per chunk, set when the chunk is written to
+    //Empty until the planes are first saved
+    std::vector<unsigned char> _changed;
+
+    void _touch(size_t offset)
+    {
+        if(_changed.size()) _changed[offset/MAZE_CHUNK_TILES] = true;
+    }
+
+    //Whether chunks not written to since base was saved or restored still match it
+    bool _matches(const Saved* base) const
+    {
+        return base && _changed.size() == _chunks && base->chunks.size() == _chunks;
+    }
+
+public:
+    MazePlanes(){}
+
+    //Planes are rounded up to whole chunks, so they save a chunk at a time
+    MazePlanes(unsigned int width, unsigned int height) :
+        _w(width), _h(height), _layout(width, height),
+        _chunks((_layout.size() + MAZE_CHUNK_TILES - 1)/MAZE_CHUNK_TILES)
+    {
+        _exits = MazePlane<unsigned char>::allocate(_chunks*MAZE_CHUNK_TILES);
+        for(auto& plane : _flags)
+            plane = MazePlane<uint64_t>::allocate(_chunks*MAZE_CHUNK_TILES/64);
+    }
+
+    //Planes on exits and uids already holding the maze, like a maze file's
+    //Only for the row major layout. exits has to run on to the end of the
+    //chunk its last tile is in
+    MazePlanes(unsigned int width, unsigned int height, const MazePlane<unsigned char>& exits, const MazePlane<uint32_t>& uids) :
+        _w(width), _h(height), _layout(width, height),
+        _chunks((_layout.size() + MAZE_CHUNK_TILES - 1)/MAZE_CHUNK_TILES), _exits(exits), _uids(uids)
+    {
+        static_assert(std::is_same<Layout, RowMajorLayout>::value, "Only row major planes can be taken as they are");
+        for(auto& plane : _flags)
+            plane = MazePlane<uint64_t>::allocate(_chunks*MAZE_CHUNK_TILES/64);
+    }
+
+    bool valid() const {return _exits.data != nullptr;}
+    const Layout& layout() const {return _layout;}
+
+    unsigned char exits(unsigned int x, unsigned int y) const {return _exits.data[_layout.offset(x, y)];}
+
+    void setExits(unsigned int x, unsigned int y, unsigned char exits)
+    {
+        size_t i = _layout.offset(x, y);
+        _exits.data[i] = exits;
+        _touch(i);
+    }
+
+    bool flag(MazeFlag f, unsigned int x, unsigned int y) const
+    {
+        size_t i = _layout.offset(x, y);
+        return (_flags[f].data[i/64] >> (i%64)) & 1;
+    }
+
+    void setFlag(MazeFlag f, unsigned int x, unsigned int y, bool value)
+    {
+        size_t i = _layout.offset(x, y);
+        if(value) _flags[f].data[i/64] |= (uint64_t)1 << (i%64);
+        else _flags[f].data[i/64] &= ~((uint64_t)1 << (i%64));
+        _touch(i);
+    }
+
+    //0 off the maze, a guarded layout's ring included
+    uint32_t uid(unsigned int x, unsigned int y) const
+    {
+        if(x >= _w || y >= _h) return 0;
+        size_t i = (size_t)_w*y + x;
+        return _uids.data ? _uids.data[i] : _key(i);
+    }
+
+    //Uids from now on are key's for each tile's row major index
+    void deriveUids(const TileUids& key)
+    {
+        _key = key;
+        _uids = MazePlane<uint32_t>();
+    }
+
+    //The first call swaps derived uids for a plane of them, all 0 but this one
+    void setUid(unsigned int x, unsigned int y, uint32_t uid)
+    {
+        if(!_uids.data) _uids = MazePlane<uint32_t>::allocate((size_t)_w*_h);
+        _uids.data[(size_t)_w*y + x] = uid;
+    }
+
+    //Copies the walls and flags, sharing every chunk not written to since
+    //base was saved or restored with base
+    Saved save(const Saved* base)
+    {
+        Saved out;
+        out.width = _w;
+        out.height = _h;
+        out.uids = _uids;
+        out.key = _key;
+
+        bool matches = _matches(base);
+        out.chunks.resize(_chunks);
+        for(size_t c=0; c<_chunks; c++)
+        {
+            if(matches && !_changed[c])
+            {
+                out.chunks[c] = base->chunks[c];
+                continue;
+            }
+
+            std::shared_ptr<Chunk> copy = std::make_shared<Chunk>();
+            std::memcpy(copy->exits, _exits.data + c*MAZE_CHUNK_TILES, MAZE_CHUNK_TILES);
+            for(unsigned int f=0; f<MAZE_FLAG_COUNT; f++)
+                std::memcpy(copy->flags[f], _flags[f].data + c*MAZE_CHUNK_TILES/64, sizeof(copy->flags[f]));
+            out.chunks[c] = copy;
+        }
+
+        _changed.assign(_chunks, false);
+        return out;
+    }
+
+    //Puts back planes saved from ones the same size. A chunk is only copied
+    //if it was written to since base or s's version differs from base's
+    void restore(const Saved& s, const Saved* base)
+    {
+        bool matches = _matches(base);
+        for(size_t c=0; c<_chunks; c++)
+        {
+            if(matches && !_changed[c] && base->chunks[c] == s.chunks[c])
+                continue;
+
+            std::memcpy(_exits.data + c*MAZE_CHUNK_TILES, s.chunks[c]->exits, MAZE_CHUNK_TILES);
+            for(unsigned int f=0; f<MAZE_FLAG_COUNT; f++)
+                std::memcpy(_flags[f].data + c*MAZE_CHUNK_TILES/64, s.chunks[c]->flags[f], sizeof(s.chunks[c]->flags[f]));
+        }
+        _uids = s.uids;
+        _key = s.key;
+
+        _changed.assign(_chunks, false);
+    }
+
+    //Bytes the planes take up, uids included when there is a plane of them
+    size_t memoryBytes() const
+    {
+        size_t out = _chunks*MAZE_CHUNK_TILES*(1 + MAZE_FLAG_COUNT/8.0);
+        if(_uids.data) out += (size_t)_w*_h*sizeof(uint32_t);
+        return out;
+    }
+};
+
+#endif
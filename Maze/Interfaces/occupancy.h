@@ -0,0 +1,174 @@
+#ifndef _OCCUPANCY_H
+#define _OCCUPANCY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//Which players stand on which tiles, kept beside the maze instead of in it
+//Every player links to the next and previous player on its tile, and a small
+//open addressing table maps each occupied tile to the first player on it.
+//Placing, moving and removing a player are O(1), and nothing is allocated
+//once the index has seen every player id
+class OccupancyIndex
+{
+public:
+    //End of a tile's list of players
+    enum : unsigned int {NONE = ~0u};
+
+private:
+    struct Slot
+    {
+        size_t tile;
+        unsigned int first = NONE; //NONE for an empty slot
+    };
+
+    //Indexed by player id
+    std::vector<size_t> _tile;
+    std::vector<unsigned int> _next, _prev;
+    std::vector<bool> _placed;
+
+    std::vector<Slot> _table;
+    size_t _mask = 0;
+    unsigned int _bits = 0;
+
+    size_t _home(size_t tile) const
+    {
+        return (size_t)(((uint64_t)tile*0x9E3779B97F4A7C15ull) >> (64 - _bits));
+    }
+
+    //Slot holding tile, or the empty slot it would go in
+    size_t _find(size_t tile) const
+    {
+        size_t i = _home(tile);
+        while(_table[i].first != NONE && _table[i].tile != tile)
+            i = (i+1) & _mask;
+        return i;
+    }
+
+    //Empties slot i, shifting back anything that probed past it
+    void _eraseSlot(size_t i)
+    {
+        size_t j = i;
+        while(true)
+        {
+            j = (j+1) & _mask;
+            if(_table[j].first == NONE) break;
+
+            size_t home = _home(_table[j].tile);
+            if(((j - home) & _mask) >= ((j - i) & _mask))
+            {
+                _table[i] = _table[j];
+                i = j;
+            }
+        }
+        _table[i].first = NONE;
+    }
+
+    //Makes room for player ids up to id, keeping the table at most half full
+    void _grow(unsigned int id)
+    {
+        if(id < _tile.size()) return;
+
+        unsigned int players = id + 1;
+        _tile.resize(players);
+        _next.resize(players, NONE);
+        _prev.resize(players, NONE);
+        _placed.resize(players, false);
+
+        if(_table.size() >= 2*players) return;
+
+        unsigned int bits = 4;
+        while(((size_t)1 << bits) < 2*players) bits++;
+
+        std::vector<Slot> old;
+        old.swap(_table);
+        _table.resize((size_t)1 << bits);
+        _mask = _table.size() - 1;
+        _bits = bits;
+        for(const Slot& s : old)
+        {
+            if(s.first != NONE)
+                _table[_find(s.tile)] = s;
+        }
+    }
+
+public:
+    //Puts a player on a tile, taking it off the one it was on
+    void place(unsigned int id, size_t tile)
+    {
+        _grow(id);
+        if(_placed[id])
+        {
+            if(_tile[id] == tile) return;
+            remove(id);
+        }
+
+        size_t slot = _find(tile);
+        _next[id] = _table[slot].first;
+        _prev[id] = NONE;
+        if(_table[slot].first != NONE)
+            _prev[_table[slot].first] = id;
+        _table[slot].tile = tile;
+        _table[slot].first = id;
+
+        _tile[id] = tile;
+        _placed[id] = true;
+    }
+
+    void remove(unsigned int id)
+    {
+        if(!placed(id)) return;
+
+        if(_prev[id] != NONE)
+            _next[_prev[id]] = _next[id];
+        else
+        {
+            size_t slot = _find(_tile[id]);
+            if(_next[id] != NONE)
+                _table[slot].first = _next[id];
+            else
+                _eraseSlot(slot);
+        }
+        if(_next[id] != NONE)
+            _prev[_next[id]] = _prev[id];
+
+        _placed[id] = false;
+    }
+
+    bool placed(unsigned int id) const {return id < _placed.size() && _placed[id];}
+    size_t tileOf(unsigned int id) const {return _tile[id];}
+
+    //One more than the highest player id the index has seen
+    unsigned int ids() const {return _tile.size();}
+
+    //Walks the players on a tile:
+    //for(unsigned int p = index.first(tile); p != OccupancyIndex::NONE; p = index.next(p))
+    unsigned int first(size_t tile) const
+    {
+        if(_table.empty()) return NONE;
+        return _table[_find(tile)].first;
+    }
+    unsigned int next(unsigned int id) const {return _next[id];}
+
+    unsigned int count(size_t tile) const
+    {
+        unsigned int out = 0;
+        for(unsigned int p = first(tile); p != NONE; p = next(p))
+            out++;
+        return out;
+    }
+
+    void clear()
+    {
+        _tile.clear();
+        _next.clear();
+        _prev.clear();
+        _placed.clear();
+        _table.clear();
+        _mask = 0;
+        _bits = 0;
+    }
+};
+
+#endif
@@ -0,0 +1,196 @@
+#ifndef _PACKED_PLANES_H
+#define _PACKED_PLANES_H
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+#include "backend_types.h"
+
+//Maze storage for mazes too big for a byte a tile, see MazePlanes for what
+//every storage has
+//Exits take 4 bits, two tiles to a byte, row major. Flags only a few tiles
+//have are sets of tile indexes, and uids are worked out from a TileUids key,
+//so a 100000x100000 maze takes 5 GB. Tiles next to each other share a byte,
+//so two threads can't write neighbouring tiles at once
+class PackedPlanes
+{
+public:
+    static const unsigned int GUARD = 0;
+    static const bool LAZY = false;
+
+    typedef std::unordered_set<size_t> FlagSet;
+
+    //MAZE_CHUNK_TILES tiles of exits
+    struct Chunk
+    {
+        unsigned char exits[MAZE_CHUNK_TILES/2];
+    };
+
+    //Read only copy of the planes. Chunks and flag sets are shared between
+    //every copy with the same ones, and uids are shared with the maze
+    struct Saved
+    {
+        unsigned int width = 0, height = 0;
+        std::vector<std::shared_ptr<const Chunk>> chunks;
+        std::shared_ptr<const FlagSet> flags[MAZE_FLAG_COUNT];
+        MazePlane<uint32_t> uids;
+        TileUids key;
+    };
+
+private:
+    unsigned int _w = 0, _h = 0;
+    size_t _chunks = 0;
+
+    MazePlane<unsigned char> _exits;
+    std::shared_ptr<FlagSet> _flags[MAZE_FLAG_COUNT];
+
+    //Row major, nullptr when uids come from _key
+    MazePlane<uint32_t> _uids;
+    TileUids _key;
+
+    //One flag per chunk and per flag set, set when it is written to
+    //Empty until the planes are first saved
+    std::vector<unsigned char> _changed;
+    std::vector<unsigned char> _flagsChanged;
+
+    size_t _index(unsigned int x, unsigned int y) const {return (size_t)_w*y + x;}
+
+    bool _matches(const Saved* base) const
+    {
+        return base && _changed.size() == _chunks && base->chunks.size() == _chunks;
+    }
+
+public:
+    PackedPlanes(){}
+
+    PackedPlanes(unsigned int width, unsigned int height) :
+        _w(width), _h(height), _chunks(((size_t)width*height + MAZE_CHUNK_TILES - 1)/MAZE_CHUNK_TILES)
+    {
+        _exits = MazePlane<unsigned char>::allocate(_chunks*MAZE_CHUNK_TILES/2);
+        for(auto& f : _flags)
+            f = std::make_shared<FlagSet>();
+    }
+
+    bool valid() const {return _exits.data != nullptr;}
+
+    unsigned char exits(unsigned int x, unsigned int y) const
+    {
+        size_t i = _index(x, y);
+        return (_exits.data[i/2] >> (i%2*4)) & 0x0F;
+    }
+
+    void setExits(unsigned int x, unsigned int y, unsigned char exits)
+    {
+        size_t i = _index(x, y);
+        unsigned char& b = _exits.data[i/2];
+        b = (b & (0xF0 >> (i%2*4))) | ((exits & 0x0F) << (i%2*4));
+        if(_changed.size()) _changed[i/MAZE_CHUNK_TILES] = true;
+    }
+
+    bool flag(MazeFlag f, unsigned int x, unsigned int y) const
+    {
+        return _flags[f]->size() && _flags[f]->count(_index(x, y));
+    }
+
+    void setFlag(MazeFlag f, unsigned int x, unsigned int y, bool value)
+    {
+        if(value) _flags[f]->insert(_index(x, y));
+        else _flags[f]->erase(_index(x, y));
+        if(_flagsChanged.size()) _flagsChanged[f] = true;
+    }
+
+    uint32_t uid(unsigned int x, unsigned int y) const
+    {
+        if(x >= _w || y >= _h) return 0;
+        size_t i = _index(x, y);
+        return _uids.data ? _uids.data[i] : _key(i);
+    }
+
+    void deriveUids(const TileUids& key)
+    {
+        _key = key;
+        _uids = MazePlane<uint32_t>();
+    }
+
+    //Uids read from a file take 4 bytes a tile again
+    void setUid(unsigned int x, unsigned int y, uint32_t uid)
+    {
+        if(!_uids.data) _uids = MazePlane<uint32_t>::allocate((size_t)_w*_h);
+        _uids.data[_index(x, y)] = uid;
+    }
+
+    Saved save(const Saved* base)
+    {
+        Saved out;
+        out.width = _w;
+        out.height = _h;
+        out.uids = _uids;
+        out.key = _key;
+
+        bool matches = _matches(base);
+        out.chunks.resize(_chunks);
+        for(size_t c=0; c<_chunks; c++)
+        {
+            if(matches && !_changed[c])
+            {
+                out.chunks[c] = base->chunks[c];
+                continue;
+            }
+
+            std::shared_ptr<Chunk> copy = std::make_shared<Chunk>();
+            std::memcpy(copy->exits, _exits.data + c*MAZE_CHUNK_TILES/2, sizeof(copy->exits));
+            out.chunks[c] = copy;
+        }
+
+        for(unsigned int f=0; f<MAZE_FLAG_COUNT; f++)
+        {
+            if(matches && !_flagsChanged[f]) out.flags[f] = base->flags[f];
+            else out.flags[f] = std::make_shared<const FlagSet>(*_flags[f]);
+        }
+
+        _changed.assign(_chunks, false);
+        _flagsChanged.assign(MAZE_FLAG_COUNT, false);
+        return out;
+    }
+
+    void restore(const Saved& s, const Saved* base)
+    {
+        bool matches = _matches(base);
+        for(size_t c=0; c<_chunks; c++)
+        {
+            if(matches && !_changed[c] && base->chunks[c] == s.chunks[c])
+                continue;
+            std::memcpy(_exits.data + c*MAZE_CHUNK_TILES/2, s.chunks[c]->exits, sizeof(s.chunks[c]->exits));
+        }
+
+        for(unsigned int f=0; f<MAZE_FLAG_COUNT; f++)
+        {
+            if(matches && !_flagsChanged[f] && base->flags[f] == s.flags[f])
+                continue;
+            *_flags[f] = *s.flags[f];
+        }
+        _uids = s.uids;
+        _key = s.key;
+
+        _changed.assign(_chunks, false);
+        _flagsChanged.assign(MAZE_FLAG_COUNT, false);
+    }
+
+    //Bytes the planes take up, roughly for the flag sets
+    size_t memoryBytes() const
+    {
+        size_t out = _chunks*MAZE_CHUNK_TILES/2;
+        for(const auto& f : _flags)
+            out += f->size()*(sizeof(size_t) + 2*sizeof(void*));
+        if(_uids.data) out += (size_t)_w*_h*sizeof(uint32_t);
+        return out;
+    }
+};
+
+//Advanced tiles packed, the maze the Advanced classes are also built for
+typedef maze<AdvancedMapTile, PackedPlanes> PackedAdvancedMaze;
+
+#endif
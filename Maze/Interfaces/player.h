@@ -4,6 +4,7 @@
 #include <string>
 
 #include "../types.h"
+#include "../mazerandom.h"
 
 template<class PlayerMoveType, class Tile>
 class Player
@@ -27,6 +28,21 @@ public:
     virtual PlayerMoveType move(const Tile* surroundings,                //Const pointer to local area
                             const uint& area_width, const uint& area_height,    //Size of local area
                             const uint& loc_x, const uint& loc_y) = 0;          //Location in local grid
+
+    //Gives the player its own random stream for the coming game
+    //Players should draw from this instead of rand() so games can be reproduced
+    //Kept after the older functions so players built before it still load
+    virtual void setRandom(const MazeRandom& rng){}
+
+    //CPU time the last move took, for players whose moves run where the game
+    //can't time them, such as in another process. Below 0 when the game
+    //should time the move on the thread that called it
+    virtual double lastMoveCpuSeconds(){return -1;}
+
+    //Called from the game's thread when it gives up on a move that never
+    //returned, while the move is still running. The player is never destroyed
+    //after this, so it should let go of anything it can without that move
+    virtual void abandon(){}
 };
 
 typedef Player<PlayerMove, MapTile> BasicPlayer;
@@ -3,9 +3,19 @@
 
 #include "backend_types.h"
 
+#include <memory>
+
+//Whatever a mover remembers between moves, saved with game snapshots
+//Only the mover that made it knows what is inside
+class MoverState
+{
+public:
+    virtual ~MoverState(){}
+};
+
 //Playermovers are templated
 //to a specific type of player object
-template<class PlayerDataType, class PlayerMoveType, class Tile>
+template<class PlayerDataType, class PlayerMoveType, class Tile, class Maze = maze<Tile>>
 class PlayerMover
 {
 public:
@@ -20,7 +30,22 @@ public:
      */
     virtual void movePlayer(PlayerDataType& playerData,
                             const PlayerMoveType& move,
-                            maze<Tile>& m) = 0;
+                            Maze& m) = 0;
+
+    /*
+     * Returns how many of the upcoming ticks would do nothing for this player
+     * except count down the move in progress. Event driven runners skip those
+     * ticks by calling skipTicks instead of movePlayer with the default move
+     */
+    virtual unsigned int idleTicks(const PlayerDataType& playerData){return 0;}
+    virtual void skipTicks(PlayerDataType& playerData, unsigned int ticks){}
+
+    /*
+     * Copies out and puts back the mover's memory of past moves
+     * Movers that remember nothing can leave these alone
+     */
+    virtual std::shared_ptr<const MoverState> saveState(){return nullptr;}
+    virtual void restoreState(const MoverState* state){}
 };
 
 #endif
\ No newline at end of file
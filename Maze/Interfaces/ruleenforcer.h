@@ -2,14 +2,19 @@
 #define _RULE_ENFORCER_H
 
 #include "backend_types.h"
-template <class PlayerType, class PlayerDataType, class Tile>
+template <class PlayerType, class PlayerDataType, class Tile, class Maze = maze<Tile>>
 class RuleEnforcer
 {
 public:
     virtual bool playerIsDifferent(const PlayerDataType& before, const PlayerDataType& after) = 0;
-    virtual PlayerDataType initPlayer(PlayerType* player, maze<Tile>& m) = 0;
-    virtual bool playerGetsTurn(PlayerDataType playerData, const maze<Tile>& m) = 0;
-    virtual bool playerIsDone(PlayerDataType playerData, const maze<Tile>& m) = 0;
+    virtual PlayerDataType initPlayer(PlayerType* player, Maze& m) = 0;
+
+    //Puts a player whose data is already known (from a replay or a saved game)
+    //back into the maze, doing whatever bookkeeping initPlayer does besides
+    //creating the data
+    virtual void placePlayer(const PlayerDataType& playerData, Maze& m){}
+    virtual bool playerGetsTurn(const PlayerDataType& playerData, const Maze& m) = 0;
+    virtual bool playerIsDone(const PlayerDataType& playerData, const Maze& m) = 0;
 };
 
 #endif
\ No newline at end of file
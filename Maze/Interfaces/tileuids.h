@@ -0,0 +1,36 @@
+#ifndef _TILE_UIDS_H
+#define _TILE_UIDS_H
+
+#include <cstdint>
+
+//Tile uids worked out from the tile's row major index
+//The index is run through a keyed permutation of the 32 bit numbers, so
+//every tile of a maze with fewer than 2^32 tiles gets a different uid
+//without remembering which were handed out, and the uids look random to a
+//player that only compares them to tell it has moved. Different keys give
+//different uids for the same tiles
+class TileUids
+{
+    uint32_t _key = 0;
+
+    //xorshift-multiply, each step undoable so the whole is a permutation
+    static uint32_t _mix(uint32_t x)
+    {
+        x ^= x >> 16;
+        x *= 0x7FEB352Du;
+        x ^= x >> 15;
+        x *= 0x846CA68Bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+public:
+    TileUids(uint32_t key = 0) : _key(_mix(key)){}
+
+    uint32_t operator()(uint64_t index) const
+    {
+        return _mix((uint32_t)index ^ _mix((uint32_t)(index >> 32) ^ _key));
+    }
+};
+
+#endif
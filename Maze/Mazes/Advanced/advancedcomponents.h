@@ -0,0 +1,25 @@
+#ifndef _ADVANCED_COMPONENTS_H
+#define _ADVANCED_COMPONENTS_H
+
+#include "advancedgenerator.h"
+#include "advancedmover.h"
+#include "advancedpartitioner.h"
+#include "advancedrules.h"
+#include "../../mazerunner.h"
+
+//Binds a runner straight to the Advanced maze classes
+//Use when the components are known at compile time; MazeRunner's default
+//still takes any generator, partitioner, mover or rules through the interfaces
+struct AdvancedComponents
+{
+    typedef maze<AdvancedMapTile> Maze;
+    typedef AdvancedGenerator Generator;
+    typedef AdvancedPartitioner Partitioner;
+    typedef AdvancedMover Mover;
+    typedef AdvancedRules Rules;
+};
+
+typedef MazeRunner<AttributePlayer, AdvancedPlayerData, AdvancedPlayerMove, AdvancedMapTile> AdvancedRunner;
+typedef MazeRunner<AttributePlayer, AdvancedPlayerData, AdvancedPlayerMove, AdvancedMapTile, AdvancedComponents> StaticAdvancedRunner;
+
+#endif
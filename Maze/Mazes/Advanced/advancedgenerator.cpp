@@ -1,35 +1,22 @@
 #include "advancedgenerator.h"
+#include "../../Interfaces/mazebits.h"
 
 #include <stack>
-#include <queue>
 #include <vector>
 #include <iostream>
 #include <cmath>
-#include <set>
-#include <unordered_map>
 
 using namespace std;
 
-maze<AdvancedMapTile> AdvancedGenerator::generateMaze(unsigned int players)
+template<class Maze>
+Maze AdvancedGeneratorT<Maze>::generateMaze(unsigned int players, MazeRandom& rng)
 {
     cerr << "Generating Maze..." << endl;
     
-    _maze = new AdvancedMapTile[_w*_h];
-    AdvancedMapTile* iter = _maze;
+    _maze = Maze(_w, _h, _wrapped);
 
-    //Assign random uids to the maze tiles
-    set<unsigned int> used;
-    for(uint i=0; i<_w*_h; i++)
-    {
-        unsigned int id;
-        do
-        {
-            id = rand();
-        }while(used.insert(id).second == false);
-        iter->uid = id;
-
-        (iter++)->exits = 0;
-    }
+    //Unique uids for the maze tiles, from one number off the stream
+    _maze.deriveUids(TileUids(rng.next()));
 
     //Non-recursive so the stack is on the heap, allowing bigger maze
     stack<point> retrace;
@@ -45,210 +32,162 @@ maze<AdvancedMapTile> AdvancedGenerator::generateMaze(unsigned int players)
         }
         else
         {
-            uint choice = rand()%dirs.size();
+            uint choice = rng.below(dirs.size());
             retrace.push(dirs[choice]);
             //cerr << dirs[choice].x << ", " << dirs[choice].y << " <-" << endl;
             _connectTiles(curr, dirs[choice]);
         }
     }
 
-    iter = _maze;
     for(uint i=0; i<_h; i++)
     {
         for(uint j=0; j<_w; j++)
         {
-            if(rand() % 100 < _cycles)
+            if(rng.below(100) < _cycles)
             {
-                iter->exits |= (rand() % 100 > 75 ? 1 : 0);
-                iter->exits |= (rand() % 100 > 75 ? 2 : 0);
-                iter->exits |= (rand() % 100 > 75 ? 4 : 0);
-                iter->exits |= (rand() % 100 > 75 ? 8 : 0);
-
-                if(iter->exits & (uint)AdvancedMapTile::Direction::NORTH)
+                point here = point{j, i};
+                unsigned char exits = _exits(here);
+                exits |= (rng.below(100) > 75 ? 1 : 0);
+                exits |= (rng.below(100) > 75 ? 2 : 0);
+                exits |= (rng.below(100) > 75 ? 4 : 0);
+                exits |= (rng.below(100) > 75 ? 8 : 0);
+
+                if(exits & (uint)AdvancedMapTile::Direction::NORTH)
                 {
-                    if(i>0) (iter-_w)->exits |= (uint)AdvancedMapTile::Direction::SOUTH;
-                    else iter->exits &= ~(uint)AdvancedMapTile::Direction::NORTH;
+                    if(i>0 || _wrapped) _open(_step(here, 0, -1), (uint)AdvancedMapTile::Direction::SOUTH);
+                    else exits &= ~(uint)AdvancedMapTile::Direction::NORTH;
                 }
 
-                if(iter->exits & (uint)AdvancedMapTile::Direction::SOUTH)
+                if(exits & (uint)AdvancedMapTile::Direction::SOUTH)
                 {
-                    if(i<_h-1) (iter+_w)->exits |= (uint)AdvancedMapTile::Direction::NORTH;
-                    else iter->exits &= ~(uint)AdvancedMapTile::Direction::SOUTH;
+                    if(i<_h-1 || _wrapped) _open(_step(here, 0, 1), (uint)AdvancedMapTile::Direction::NORTH);
+                    else exits &= ~(uint)AdvancedMapTile::Direction::SOUTH;
                 }
 
-                if(iter->exits & (uint)AdvancedMapTile::Direction::WEST)
+                if(exits & (uint)AdvancedMapTile::Direction::WEST)
                 {
-                    if(j>0) (iter-1)->exits |= (uint)AdvancedMapTile::Direction::EAST;
-                    else iter->exits &= ~(uint)AdvancedMapTile::Direction::WEST;
+                    if(j>0 || _wrapped) _open(_step(here, -1, 0), (uint)AdvancedMapTile::Direction::EAST);
+                    else exits &= ~(uint)AdvancedMapTile::Direction::WEST;
                 }
 
-                if(iter->exits & (uint)AdvancedMapTile::Direction::EAST)
+                if(exits & (uint)AdvancedMapTile::Direction::EAST)
                 {
-                    if(j<_w-1) (iter+1)->exits |= (uint)AdvancedMapTile::Direction::WEST;
-                    else iter->exits &= ~(uint)AdvancedMapTile::Direction::EAST;
+                    if(j<_w-1 || _wrapped) _open(_step(here, 1, 0), (uint)AdvancedMapTile::Direction::WEST);
+                    else exits &= ~(uint)AdvancedMapTile::Direction::EAST;
                 }
-            }
 
-            ++iter;
+                _maze.setExits(j, i, exits);
+            }
         }
     }
 
-    maze<AdvancedMapTile> out(_maze, _w, _h, false);
+    Maze out = _maze;
+    _maze = Maze();
 
-    out.exit = point{rand()%_w, rand()%_h};
+    out.exit = point{rng.below(_w), rng.below(_h)};
     //cerr << "Maze exit: " << out.exit.x << ", " << out.exit.y << endl;
-    _maze[_w*out.exit.y + out.exit.x].isExit = true;
-
-    unordered_map<uint, unordered_map<uint, bool>> visited;
-    vector<queue<point>> startSets;
-    vector<queue<point>> smallSets;
-    queue<point> front;
-    front.push(out.exit);
-    visited[out.exit.x][out.exit.y] = true;
-    while(front.size())
-    {
-        if(front.size() >= players)
-        {
-            //cerr << "Added front size " << front.size() << endl;
-            startSets.push_back(front);
-        }
-        else
-            smallSets.push_back(front);
+    out.setFlag(MAZE_FLAG_EXIT, out.exit, true);
 
-        int frontSize = front.size();
-        for(int i=0; i<frontSize; i++)
-        {
-            point next = front.front();
-            front.pop();
+    //Every tile reached from the exit, a layer at a time
+    vector<uint> order;
+    vector<size_t> layerSize;
+    flatLayers(out, out.exit, order, layerSize);
 
-            uint curr = out.at(next.x, next.y).exits;
-            point add;
-            if(curr & (uint)AdvancedMapTile::Direction::NORTH)
-            {
-                add = point{next.x, next.y-1};
-                if(!visited[add.x][add.y])
-                {
-                    visited[add.x][add.y] = true;
-                    front.push(add);
-                }
-            }
+    //Pick a random layer to start on from the second half of the ones big
+    //enough for everyone, to give some variety, or the furthest if none are
+    vector<uint> startLayers;
+    for(uint d=0; d<layerSize.size(); d++)
+        if(layerSize[d] >= players) startLayers.push_back(d);
 
-            if(curr & (uint)AdvancedMapTile::Direction::SOUTH)
-            {
-                add = point{next.x, next.y+1};
-                if(!visited[add.x][add.y])
-                {
-                    visited[add.x][add.y] = true;
-                    front.push(add);
-                }
-            }
+    uint layer = layerSize.size() - 1;
+    if(startLayers.size() > 1)
+        layer = startLayers[rng.below(startLayers.size()/2) + startLayers.size()/2];
+    else if(startLayers.size() == 1)
+        layer = startLayers[0];
 
-            if(curr & (uint)AdvancedMapTile::Direction::EAST)
-            {
-                add = point{next.x+1, next.y};
-                if(!visited[add.x][add.y])
-                {
-                    visited[add.x][add.y] = true;
-                    front.push(add);
-                }
-            }
-
-            if(curr & (uint)AdvancedMapTile::Direction::WEST)
-            {
-                add = point{next.x-1, next.y};
-                if(!visited[add.x][add.y])
-                {
-                    visited[add.x][add.y] = true;
-                    front.push(add);
-                }
-            }
-        }
-    }
-
-    //Pick a random set of starts from the second half of the sets
-    //To give some variety
-    queue<point> startQ;
-    if(startSets.size() > 1)
-    {
-        startQ = startSets[rand()%(startSets.size()/2) + startSets.size()/2];
-    }
-    else if(startSets.size() == 1)
-    {
-        startQ = startSets[0];
-    }
-    else
-    {
-        startQ = smallSets.back();
-    }
+    size_t first = 0;
+    for(uint d=0; d<layer; d++)
+        first += layerSize[d];
 
     vector<point> starts;
+    for(size_t i=first; i<first + layerSize[layer]; i++)
+        starts.push_back(point{order[i] % _w, order[i] / _w});
 
-    //cerr << "Picking player starts from " << startQ.size() << endl;
-    while(startQ.size())
-    {
-        starts.push_back(startQ.front());
-        startQ.pop();
-    }
-
-    vector<point> list;
-
-    for(uint i=0; i<players; i++)
-    {
-        if(list.size() == 0) list = starts;
-        int startInd = rand()%list.size();
-        out.players.push_back(list[startInd]);
-        list.erase(list.begin() + startInd);
-    }
+    out.players = pickStarts(starts, players, rng);
 
     cout << "Done!" << endl;
 
     return out;
 }
 
-void AdvancedGenerator::_connectTiles(const point& a, const point& b)
+template<class Maze>
+void AdvancedGeneratorT<Maze>::_connectTiles(const point& a, const point& b)
 {
     //cerr << a.x << ", " << a.y << " <-> " << b.x << ", " << b.y << endl;
-    if(a.x == b.x-1 && a.y == b.y)
+    long long dx = wrappedDelta(a.x, b.x, _w, _wrapped);
+    long long dy = wrappedDelta(a.y, b.y, _h, _wrapped);
+    if(dx == 1 && dy == 0)
     {
-        _tile(a).exits |= (unsigned char)AdvancedMapTile::Direction::EAST;
-        _tile(b).exits |= (unsigned char)AdvancedMapTile::Direction::WEST;
+        _open(a, (unsigned char)AdvancedMapTile::Direction::EAST);
+        _open(b, (unsigned char)AdvancedMapTile::Direction::WEST);
     }
-    else if(a.x == b.x+1 && a.y == b.y)
+    else if(dx == -1 && dy == 0)
     {
-        _tile(a).exits |= (unsigned char)AdvancedMapTile::Direction::WEST;
-        _tile(b).exits |= (unsigned char)AdvancedMapTile::Direction::EAST;
+        _open(a, (unsigned char)AdvancedMapTile::Direction::WEST);
+        _open(b, (unsigned char)AdvancedMapTile::Direction::EAST);
     }
-    else if(a.x == b.x && a.y == b.y-1)
+    else if(dx == 0 && dy == 1)
     {
-        _tile(a).exits |= (unsigned char)AdvancedMapTile::Direction::SOUTH;
-        _tile(b).exits |= (unsigned char)AdvancedMapTile::Direction::NORTH;
+        _open(a, (unsigned char)AdvancedMapTile::Direction::SOUTH);
+        _open(b, (unsigned char)AdvancedMapTile::Direction::NORTH);
     }
-    else if(a.x == b.x && a.y == b.y+1)
+    else if(dx == 0 && dy == -1)
     {
-        _tile(a).exits |= (unsigned char)AdvancedMapTile::Direction::NORTH;
-        _tile(b).exits |= (unsigned char)AdvancedMapTile::Direction::SOUTH;
+        _open(a, (unsigned char)AdvancedMapTile::Direction::NORTH);
+        _open(b, (unsigned char)AdvancedMapTile::Direction::SOUTH);
     }
 }
 
-vector<point> AdvancedGenerator::_getEmptyAdjacent(const point& loc)
+template<class Maze>
+vector<point> AdvancedGeneratorT<Maze>::_getEmptyAdjacent(const point& loc)
 {
     vector<point> out;
-    if(loc.x > 0 && _tile(point{loc.x - 1, loc.y}).exits == (unsigned char)AdvancedMapTile::Direction::NONE)
-        out.push_back(point{loc.x - 1, loc.y});
+    if((loc.x > 0 || _wrapped) && _exits(_step(loc, -1, 0)) == (unsigned char)AdvancedMapTile::Direction::NONE)
+        out.push_back(_step(loc, -1, 0));
 
-    if(loc.x + 1 < _w && _tile(point{loc.x + 1, loc.y}).exits == (unsigned char)AdvancedMapTile::Direction::NONE)
-        out.push_back(point{loc.x + 1, loc.y});
+    if((loc.x + 1 < _w || _wrapped) && _exits(_step(loc, 1, 0)) == (unsigned char)AdvancedMapTile::Direction::NONE)
+        out.push_back(_step(loc, 1, 0));
 
-    if(loc.y > 0 && _tile(point{loc.x, loc.y - 1}).exits == (unsigned char)AdvancedMapTile::Direction::NONE)
-        out.push_back(point{loc.x, loc.y - 1});
+    if((loc.y > 0 || _wrapped) && _exits(_step(loc, 0, -1)) == (unsigned char)AdvancedMapTile::Direction::NONE)
+        out.push_back(_step(loc, 0, -1));
 
-    if(loc.y + 1 < _h && _tile(point{loc.x, loc.y + 1}).exits == (unsigned char)AdvancedMapTile::Direction::NONE)
-        out.push_back(point{loc.x, loc.y + 1});
+    if((loc.y + 1 < _h || _wrapped) && _exits(_step(loc, 0, 1)) == (unsigned char)AdvancedMapTile::Direction::NONE)
+        out.push_back(_step(loc, 0, 1));
 
     return out;
 }
 
-AdvancedMapTile& AdvancedGenerator::_tile(const point &loc)
+//The tile dx, dy from loc, round the edges when the maze wraps
+template<class Maze>
+point AdvancedGeneratorT<Maze>::_step(const point& loc, int dx, int dy) const
+{
+    if(!_wrapped) return point{loc.x + dx, loc.y + dy};
+    return point{(loc.x + _w + dx) % _w, (loc.y + _h + dy) % _h};
+}
+
+template<class Maze>
+unsigned char AdvancedGeneratorT<Maze>::_exits(const point &loc) const
+{
+    return _maze.exits(loc.x, loc.y);
+}
+
+template<class Maze>
+void AdvancedGeneratorT<Maze>::_open(const point& loc, unsigned char exits)
 {
-    return _maze[loc.y*_w + loc.x];
+    _maze.addExits(loc.x, loc.y, exits);
 }
+
+template class AdvancedGeneratorT<maze<AdvancedMapTile>>;
+template class AdvancedGeneratorT<BlockedAdvancedMaze>;
+template class AdvancedGeneratorT<GuardedAdvancedMaze>;
+template class AdvancedGeneratorT<PackedAdvancedMaze>;
@@ -5,23 +5,36 @@
 #include "../../types.h"
 #include "../../attributeTypes.h"
 #include "../../Interfaces/backend_types.h"
+#include "../../Interfaces/packedplanes.h"
+#include "../../Interfaces/tileuids.h"
 
-class AdvancedGenerator : public MazeGenerator<AdvancedMapTile>
+//Built for maze<AdvancedMapTile>, BlockedAdvancedMaze, GuardedAdvancedMaze,
+//and PackedAdvancedMaze in advancedgenerator.cpp
+template<class Maze>
+class AdvancedGeneratorT final : public MazeGenerator<AdvancedMapTile, Maze>
 {
-    AdvancedMapTile* _maze;
+    Maze _maze;
     unsigned int _w, _h;
     double _cycles;
+    bool _wrapped;
 
     void _connectTiles(const point& a, const point& b);
-    AdvancedMapTile& _tile(const point &loc);
+    point _step(const point& loc, int dx, int dy) const;
+    unsigned char _exits(const point &loc) const;
+    void _open(const point& loc, unsigned char exits);
     std::vector<point> _getEmptyAdjacent(const point& loc);
 public:
-    AdvancedGenerator(int width, int height, double percentCycles = 0) : _w(width), _h(height), _cycles(percentCycles){}
+    //Wrapped mazes join each edge to the opposite one, so there are no edges
+    //Mazes narrower than 3 tiles can't wrap, their neighbours would meet twice
+    AdvancedGeneratorT(int width, int height, double percentCycles = 0, bool wrapped = false) :
+        _w(width), _h(height), _cycles(percentCycles), _wrapped(wrapped && width > 2 && height > 2){}
 
-    maze<AdvancedMapTile> generateMaze(unsigned int players);
+    Maze generateMaze(unsigned int players, MazeRandom& rng);
 
     //Returns whether or not the maze wraps around on the edges
-    bool isWrapped(){return false;}
+    bool isWrapped(){return _wrapped;}
 };
 
+typedef AdvancedGeneratorT<maze<AdvancedMapTile>> AdvancedGenerator;
+
 #endif
\ No newline at end of file
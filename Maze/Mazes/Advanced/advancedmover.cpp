@@ -11,157 +11,201 @@ MazePoint operator + (const MazePoint& l, const MazePoint& r)
     return MazePoint{l.x + r.x, l.y + r.y};
 }
 
-bool AdvancedMover::adjacentAndConnected(maze<AdvancedMapTile>& m, const MazePoint& p1, const MazePoint& p2)
+template<class Maze>
+bool AdvancedMoverT<Maze>::visited(int id, uint x, uint y, const Maze& m)
 {
-    return adjacentAndConnected(m, p1.x, p1.y, p2.x, p2.y);
+    if(x >= m.width() || y >= m.height()) return false;
+
+    const VisitedTiles& tiles = _visited[id];
+    size_t size = (size_t)m.width()*m.height();
+    return tiles.tiles() == size && tiles.test((size_t)m.width()*y + x);
+}
+
+template<class Maze>
+void AdvancedMoverT<Maze>::markVisited(int id, uint x, uint y, const Maze& m)
+{
+    if(x >= m.width() || y >= m.height()) return;
+
+    //A different sized maze means a new game
+    VisitedTiles& tiles = _visited[id];
+    size_t size = (size_t)m.width()*m.height();
+    if(tiles.tiles() != size)
+        tiles.reset(size);
+    tiles.set((size_t)m.width()*y + x);
+}
+
+template<class Maze>
+bool AdvancedMoverT<Maze>::adjacentAndConnected(Maze& m, const MazePoint& p1, const MazePoint& p2)
+{
+    return adjacentAndConnected(m, m.wrapX(p1.x), m.wrapY(p1.y), m.wrapX(p2.x), m.wrapY(p2.y));
 }
 
-bool AdvancedMover::adjacentAndConnected(maze<AdvancedMapTile>& m, const uint& x1, const uint& y1, const uint& x2, const uint& y2)
+template<class Maze>
+bool AdvancedMoverT<Maze>::adjacentAndConnected(Maze& m, const uint& x1, const uint& y1, const uint& x2, const uint& y2)
 {
-    //Check if tiles are not adjacent
+    //Check if tiles are not adjacent, going round the edges of wrapped mazes
     //std::cerr << "Checking " << x1 << ", " << y1 << " : " << x2 << ", " << y2 << std::endl;
-    if(abs((long long)x1-(long long)x2) + abs((long long)y1-(long long)y2) != 1) 
+    long long dx = wrappedDelta(x1, x2, m.width(), m.wrapped());
+    long long dy = wrappedDelta(y1, y2, m.height(), m.wrapped());
+    if(abs(dx) + abs(dy) != 1) 
     {
         //std::cerr << "Rooms not adjacent" << std::endl;
         return false;
     }
 
     //Check if connected
-    AdvancedMapTile t1 = m.at(x1, y1);
-    AdvancedMapTile t2 = m.at(x2, y2);
+    unsigned char e1 = m.exits(x1, y1);
+    unsigned char e2 = m.exits(x2, y2);
 
-    if(x1 == x2 - 1 &&
-     (t1.exits & (uint) AdvancedMapTile::Direction::EAST) && (t2.exits & (uint) AdvancedMapTile::Direction::WEST)) return true;
+    if(dx == 1 &&
+     (e1 & (uint) AdvancedMapTile::Direction::EAST) && (e2 & (uint) AdvancedMapTile::Direction::WEST)) return true;
 
-    if(x1 == x2 + 1 &&
-     (t1.exits & (uint) AdvancedMapTile::Direction::WEST) && (t2.exits & (uint) AdvancedMapTile::Direction::EAST)) return true;
+    if(dx == -1 &&
+     (e1 & (uint) AdvancedMapTile::Direction::WEST) && (e2 & (uint) AdvancedMapTile::Direction::EAST)) return true;
 
-    if(y1 == y2 - 1 &&
-     (t1.exits & (uint) AdvancedMapTile::Direction::SOUTH) && (t2.exits & (uint) AdvancedMapTile::Direction::NORTH)) return true;
+    if(dy == 1 &&
+     (e1 & (uint) AdvancedMapTile::Direction::SOUTH) && (e2 & (uint) AdvancedMapTile::Direction::NORTH)) return true;
 
-    if(y1 == y2 + 1 &&
-     (t1.exits & (uint) AdvancedMapTile::Direction::NORTH) && (t2.exits & (uint) AdvancedMapTile::Direction::SOUTH)) return true;
+    if(dy == -1 &&
+     (e1 & (uint) AdvancedMapTile::Direction::NORTH) && (e2 & (uint) AdvancedMapTile::Direction::SOUTH)) return true;
 
      return false;
 }
 
-MazePoint AdvancedMover::closestPointToExit(MazePoint current, maze<AdvancedMapTile>& m)
+template<class Maze>
+void AdvancedMoverT<Maze>::updateBits(Maze& m)
 {
-    queue<MazePoint> bfs;
-    unordered_map<int, unordered_map<int, int>> distances;
-    int currDist = 1;
-    int frontSize = 1;
-    distances[m.exit.x][m.exit.y] = 1;
-    bfs.push(MazePoint(m.exit.x, m.exit.y));
-
-    //std::cerr << "--------------------------------" << std::endl;
-    while(bfs.size())
+    //A new maze, or one put back from a snapshot, has to be read in whole
+    if(!m.journal.valid(_bitsChanges))
     {
-        //std::cerr << "Distance: " << currDist << std::endl;
-        int nextFront = 0;
-        for(int i=0; i<frontSize; i++)
-        {
-            MazePoint next = bfs.front();
-            bfs.pop();
-            //std::cerr << next.x << ", " << next.y << std::endl;
-
-            //If we reach the player location, check which of the four directions we came from
-            if(next.x == current.x && next.y == current.y)
-            {
-                if(adjacentAndConnected(m, next, next+MazePoint{-1, 0}) && 
-                    distances[next.x-1][next.y] == currDist-1) return MazePoint{next.x-1, next.y};
-                if(adjacentAndConnected(m, next, next+MazePoint{1, 0}) && 
-                    distances[next.x+1][next.y] == currDist-1) return MazePoint{next.x+1, next.y};
-                if(adjacentAndConnected(m, next, next+MazePoint{0, -1}) && 
-                    distances[next.x][next.y-1] == currDist-1) return MazePoint{next.x, next.y-1};
-                if(adjacentAndConnected(m, next, next+MazePoint{0, 1}) && 
-                    distances[next.x][next.y+1] == currDist-1) return MazePoint{next.x, next.y+1};
-
-                //Should only happen if they use luck from in a walls only room
-                cout << "You are REALLY unlucky!" << endl;
-                return current;
-            }
+        _bits = MazeBits(m);
+        _flood = MazeFlood(_bits);
+        _bitsChanges = m.journal.subscribe();
+        return;
+    }
 
-            if(adjacentAndConnected(m, next, next+MazePoint{0, -1})
-                && distances[next.x][next.y-1] == 0)
-            {
-                distances[next.x][next.y-1] = currDist+1;
+    m.journal.read(_bitsChanges, [this, &m](const MazeChange<AdvancedMapTile>& c)
+    {
+        if(c.before.exits != c.after.exits)
+            _bits.update(m, c.tile % m.width(), c.tile / m.width());
+    });
+}
 
-                nextFront++;
-                bfs.push(MazePoint{next.x, next.y-1});
-            }
-            if(adjacentAndConnected(m, next, next+MazePoint{0, 1})
-                && distances[next.x][next.y+1] == 0)
-            {
-                distances[next.x][next.y+1] = currDist+1;
+template<class Maze>
+MazePoint AdvancedMoverT<Maze>::closestPointToExit(MazePoint current, Maze& m)
+{
+    //Neighbouring tile, round the edges of a wrapped maze
+    auto step = [&m](const MazePoint& p, int dx, int dy)
+    {
+        return MazePoint{m.wrapX(p.x + dx), m.wrapY(p.y + dy)};
+    };
 
-                nextFront++;
-                bfs.push(MazePoint{next.x, next.y+1});
-            }
-            if(adjacentAndConnected(m, next, next+MazePoint{1, 0})
-                && distances[next.x+1][next.y] == 0)
-            {
-                distances[next.x+1][next.y] = currDist+1;
+    //Off the edge of the maze after phasing through its outer wall
+    if(current.x < 0 || current.y < 0 || current.x >= m.width() || current.y >= m.height())
+    {
+        cout << "You are unlucky!" << endl;
+        return current;
+    }
 
-                nextFront++;
-                bfs.push(MazePoint{next.x+1, next.y});
-            }
-            if(adjacentAndConnected(m, next, next+MazePoint{-1, 0})
-                && distances[next.x-1][next.y] == 0)
-            {
-                distances[next.x-1][next.y] = currDist+1;
+    //Tiles of a lazy maze are made as they are read, so only search as far
+    //out from the exit as the player
+    if(Maze::StorageType::LAZY)
+    {
+        unordered_map<size_t, unsigned int> distance;
+        vector<point> order;
+        vector<size_t> layerSize;
+        point at{(unsigned long long)current.x, (unsigned long long)current.y};
+        nearLayers(m, m.exit, LAZY_SEARCH_TILES, &at, distance, order, layerSize);
+
+        auto here = distance.find(m.index(at.x, at.y));
+        if(here == distance.end())
+        {
+            cout << "You are unlucky!" << endl;
+            return current;
+        }
+        if(here->second == 0) return current;
 
-                nextFront++;
-                bfs.push(MazePoint{next.x-1, next.y});
-            }
+        MazePoint north = step(current, 0, -1), south = step(current, 0, 1);
+        MazePoint east = step(current, 1, 0), west = step(current, -1, 0);
+        for(const MazePoint& p : {west, east, north, south})
+        {
+            auto there = distance.find(m.index(p.x, p.y));
+            if(adjacentAndConnected(m, current, p) && there != distance.end() && there->second + 1 == here->second)
+                return p;
         }
-        currDist++;
-        frontSize = nextFront;
+
+        cout << "You are REALLY unlucky!" << endl;
+        return current;
     }
 
+    //Flood out from the exit a layer at a time until it reaches the player
+    updateBits(m);
+    MazeFlood& flood = _flood;
+    flood.start(m.exit.x, m.exit.y);
+    do
+    {
+        if(!flood.inFront(current.x, current.y)) continue;
+
+        //Already there
+        if(flood.depth() == 0) return current;
+
+        //A connected neighbour reached before this layer is one step closer,
+        //check which of the four directions we came from
+        MazePoint north = step(current, 0, -1), south = step(current, 0, 1);
+        MazePoint east = step(current, 1, 0), west = step(current, -1, 0);
+        for(const MazePoint& p : {west, east, north, south})
+        {
+            if(adjacentAndConnected(m, current, p) && flood.reached(p.x, p.y) && !flood.inFront(p.x, p.y))
+                return p;
+        }
+
+        //Should only happen if they use luck from in a walls only room
+        cout << "You are REALLY unlucky!" << endl;
+        return current;
+    }while(flood.step());
+
     cout << "You are unlucky!" << endl;;
     return current;
 }
 
 
-void AdvancedMover::performPlayerPendingMove(AdvancedPlayerData& playerData,
-                                  maze<AdvancedMapTile>& m)
+template<class Maze>
+void AdvancedMoverT<Maze>::performPlayerPendingMove(AdvancedPlayerData& playerData,
+                                  Maze& m)
 {
     bool playerMoved = false;
-    uint startx = playerData.x;
-    uint starty = playerData.y;
-    _visited[playerData.id][playerData.x][playerData.y] = true;
+    markVisited(playerData.id, playerData.x, playerData.y, m);
     switch(playerData.moveInProgress.attemptedMove)
     {
         case AdvancedPlayerMove::Move::NOOP: return;
 
         case AdvancedPlayerMove::Move::MOVETO:
-            playerData.x += playerData.moveInProgress.destination.x;
-            playerData.y += playerData.moveInProgress.destination.y;
+            playerData.x = m.wrapX(playerData.x + playerData.moveInProgress.destination.x);
+            playerData.y = m.wrapY(playerData.y + playerData.moveInProgress.destination.y);
 
             playerMoved = true;
         break;
 
         case AdvancedPlayerMove::Move::WALLBREAK:
         {
-            m.at(playerData.x, playerData.y).exits |= (unsigned char)playerData.moveInProgress.dir;
+            m.addExits(playerData.x, playerData.y, (unsigned char)playerData.moveInProgress.dir);
             switch(playerData.moveInProgress.dir)
             {
                 case AdvancedMapTile::Direction::NORTH:
-                    playerData.y--;
-                    m.at(playerData.x, playerData.y).exits |= ((unsigned char)AdvancedMapTile::Direction::SOUTH);
+                    playerData.y = m.wrapY((long long)playerData.y - 1);
+                    m.addExits(playerData.x, playerData.y, ((unsigned char)AdvancedMapTile::Direction::SOUTH));
                     break;
                 case AdvancedMapTile::Direction::SOUTH:
-                    playerData.y++;
-                    m.at(playerData.x, playerData.y).exits |= ((unsigned char)AdvancedMapTile::Direction::NORTH);
+                    playerData.y = m.wrapY((long long)playerData.y + 1);
+                    m.addExits(playerData.x, playerData.y, ((unsigned char)AdvancedMapTile::Direction::NORTH));
                     break;
                 case AdvancedMapTile::Direction::WEST:
-                    playerData.x--;
-                    m.at(playerData.x, playerData.y).exits |= ((unsigned char)AdvancedMapTile::Direction::EAST);
+                    playerData.x = m.wrapX((long long)playerData.x - 1);
+                    m.addExits(playerData.x, playerData.y, ((unsigned char)AdvancedMapTile::Direction::EAST));
                     break;
                 case AdvancedMapTile::Direction::EAST:
-                    playerData.x++;
-                    m.at(playerData.x, playerData.y).exits |= ((unsigned char)AdvancedMapTile::Direction::WEST);
+                    playerData.x = m.wrapX((long long)playerData.x + 1);
+                    m.addExits(playerData.x, playerData.y, ((unsigned char)AdvancedMapTile::Direction::WEST));
                     break;
                 default: break;
             }
@@ -173,16 +217,16 @@ void AdvancedMover::performPlayerPendingMove(AdvancedPlayerData& playerData,
             switch(playerData.moveInProgress.dir)
             {
                 case AdvancedMapTile::Direction::NORTH:
-                    playerData.y--;
+                    playerData.y = m.wrapY((long long)playerData.y - 1);
                     break;
                 case AdvancedMapTile::Direction::SOUTH:
-                    playerData.y++;
+                    playerData.y = m.wrapY((long long)playerData.y + 1);
                     break;
                 case AdvancedMapTile::Direction::WEST:
-                    playerData.x--;
+                    playerData.x = m.wrapX((long long)playerData.x - 1);
                     break;
                 case AdvancedMapTile::Direction::EAST:
-                    playerData.x++;
+                    playerData.x = m.wrapX((long long)playerData.x + 1);
                     break;
                 default: 
                     break;
@@ -192,7 +236,7 @@ void AdvancedMover::performPlayerPendingMove(AdvancedPlayerData& playerData,
         break;
         case AdvancedPlayerMove::Move::STICKYBOMB:
             playerData.stickyBombs--;
-            m.at(playerData.x, playerData.y).hasStickyBomb = true;
+            m.setFlag(MAZE_FLAG_STICKY_BOMB, playerData.x, playerData.y, true);
         break;
         case AdvancedPlayerMove::Move::LUCK:
         {
@@ -209,16 +253,17 @@ void AdvancedMover::performPlayerPendingMove(AdvancedPlayerData& playerData,
     //If so, change the ticksLeftForCurrentMove so they have to wait to move
     if(playerMoved)
     {
-        auto& newTile = m.at(playerData.x, playerData.y);
-        auto& oldTile = m.at(startx, starty);
-
-        auto iter = find(oldTile.players.begin(), oldTile.players.end(), playerData.id);
-        if(iter != oldTile.players.end())
+        //Phasing through the outer wall leaves the maze, and index() of a
+        //tile off the edge is some other tile's
+        if(playerData.id >= 0)
         {
-            oldTile.players.erase(iter);
+            if(playerData.x < m.width() && playerData.y < m.height())
+                m.occupants.place(playerData.id, m.index(playerData.x, playerData.y));
+            else
+                m.occupants.remove(playerData.id);
         }
-        newTile.players.push_back(playerData.id);
-        if(newTile.hasStickyBomb)
+
+        if(m.flag(MAZE_FLAG_STICKY_BOMB, playerData.x, playerData.y))
         {
             if(playerData.stickyBombAvoids > 0)
                 playerData.stickyBombAvoids--;
@@ -231,54 +276,57 @@ void AdvancedMover::performPlayerPendingMove(AdvancedPlayerData& playerData,
     }
 }
 
-bool AdvancedMover::isValidMove(AdvancedPlayerData& playerData, 
+template<class Maze>
+bool AdvancedMoverT<Maze>::isValidMove(AdvancedPlayerData& playerData, 
                      const AdvancedPlayerMove& move,
-                     maze<AdvancedMapTile>& m)
+                     Maze& m)
 {
     switch(move.attemptedMove)
     {
         case AdvancedPlayerMove::Move::NOOP: return true;
         case AdvancedPlayerMove::Move::MOVETO:
         {
-            AdvancedMapTile currTile = m.at(playerData.x, playerData.y);
+            unsigned char exits = m.exits(playerData.x, playerData.y);
 
             //Check if they're trying to move any of the four cardinal directions
             if(move.destination.x == 0 && move.destination.y == 1 && 
-               (currTile.exits & (unsigned int) AdvancedMapTile::Direction::SOUTH) > 0) return true;
+               (exits & (unsigned int) AdvancedMapTile::Direction::SOUTH) > 0) return true;
                
             if(move.destination.x == 0 && move.destination.y == -1 && 
-               (currTile.exits & (unsigned int) AdvancedMapTile::Direction::NORTH) > 0) return true;
+               (exits & (unsigned int) AdvancedMapTile::Direction::NORTH) > 0) return true;
 
             if(move.destination.x == 1 && move.destination.y == 0 && 
-               (currTile.exits & (unsigned int) AdvancedMapTile::Direction::EAST) > 0) return true;
+               (exits & (unsigned int) AdvancedMapTile::Direction::EAST) > 0) return true;
 
             if(move.destination.x == -1 && move.destination.y == 0 && 
-               (currTile.exits & (unsigned int) AdvancedMapTile::Direction::WEST) > 0) return true;
+               (exits & (unsigned int) AdvancedMapTile::Direction::WEST) > 0) return true;
 
             //Check if trying to teleport to a previously visited location
-            uint targetX = playerData.x+move.destination.x;
-            uint targetY = playerData.y+move.destination.y;
-            if(_visited[playerData.id][targetX][targetY])
+            uint targetX = m.wrapX(playerData.x+move.destination.x);
+            uint targetY = m.wrapY(playerData.y+move.destination.y);
+            if(visited(playerData.id, targetX, targetY, m))
                 return true;
 
-            if(_visited[playerData.id][targetX-1][targetY] && adjacentAndConnected(m, targetX, targetY, targetX-1, targetY))
+            uint westX = m.wrapX((long long)targetX-1), eastX = m.wrapX((long long)targetX+1);
+            uint northY = m.wrapY((long long)targetY-1), southY = m.wrapY((long long)targetY+1);
+            if(visited(playerData.id, westX, targetY, m) && adjacentAndConnected(m, targetX, targetY, westX, targetY))
                 return true;
 
-            if(_visited[playerData.id][targetX+1][targetY] && adjacentAndConnected(m, targetX, targetY, targetX+1, targetY))
+            if(visited(playerData.id, eastX, targetY, m) && adjacentAndConnected(m, targetX, targetY, eastX, targetY))
                 return true;         
 
-            if(_visited[playerData.id][targetX][targetY-1] && adjacentAndConnected(m, targetX, targetY, targetX, targetY-1))
+            if(visited(playerData.id, targetX, northY, m) && adjacentAndConnected(m, targetX, targetY, targetX, northY))
                 return true;            
 
-            if(_visited[playerData.id][targetX][targetY+1] && adjacentAndConnected(m, targetX, targetY, targetX, targetY+1))
+            if(visited(playerData.id, targetX, southY, m) && adjacentAndConnected(m, targetX, targetY, targetX, southY))
                 return true;
 
             return false;
         }
         case AdvancedPlayerMove::Move::WALLBREAK:
         {
-            AdvancedMapTile currTile = m.at(playerData.x, playerData.y);
-            if((currTile.exits & (unsigned char)move.dir) == 0)
+            unsigned char exits = m.exits(playerData.x, playerData.y);
+            if((exits & (unsigned char)move.dir) == 0)
             {
                 return playerData.wallBreaksLeft > 0;
             }
@@ -287,8 +335,8 @@ bool AdvancedMover::isValidMove(AdvancedPlayerData& playerData,
         }
         case AdvancedPlayerMove::Move::WALLPHASE:
         {
-            AdvancedMapTile currTile = m.at(playerData.x, playerData.y);
-            if((currTile.exits & (unsigned char)move.dir) == 0)
+            unsigned char exits = m.exits(playerData.x, playerData.y);
+            if((exits & (unsigned char)move.dir) == 0)
                 return playerData.wallPhaseLeft > 0;
             
             return false;
@@ -308,9 +356,10 @@ bool AdvancedMover::isValidMove(AdvancedPlayerData& playerData,
 }
 
 //Right now, all moves take same number of ticks
-int AdvancedMover::moveLength(AdvancedPlayerData& playerData, 
+template<class Maze>
+int AdvancedMoverT<Maze>::moveLength(AdvancedPlayerData& playerData, 
                 const AdvancedPlayerMove& move,
-                maze<AdvancedMapTile>& m)
+                Maze& m)
 {
     return playerData.ticksPerTurn;
 }
@@ -318,9 +367,10 @@ int AdvancedMover::moveLength(AdvancedPlayerData& playerData,
 
 //Assign move in moveInProgress
 //Assign amount of time ticks the move takes
-void AdvancedMover::setupNextPlayerMove(AdvancedPlayerData& playerData,
+template<class Maze>
+void AdvancedMoverT<Maze>::setupNextPlayerMove(AdvancedPlayerData& playerData,
                         const AdvancedPlayerMove& move,
-                        maze<AdvancedMapTile>& m)
+                        Maze& m)
 {
     if(isValidMove(playerData, move, m))
     {
@@ -334,9 +384,10 @@ void AdvancedMover::setupNextPlayerMove(AdvancedPlayerData& playerData,
     }
 }
 
-void AdvancedMover::movePlayer(AdvancedPlayerData& playerData,
+template<class Maze>
+void AdvancedMoverT<Maze>::movePlayer(AdvancedPlayerData& playerData,
                     const AdvancedPlayerMove& move,
-                    maze<AdvancedMapTile>& m)
+                    Maze& m)
 {
     //Tick down to 1, and perform the move
     //Then next turn see what their next move is
@@ -347,3 +398,27 @@ void AdvancedMover::movePlayer(AdvancedPlayerData& playerData,
         setupNextPlayerMove(playerData, move, m);
     playerData.ticksLeftForCurrentMove--;
 }
+
+template<class Maze>
+std::shared_ptr<const MoverState> AdvancedMoverT<Maze>::saveState()
+{
+    std::shared_ptr<State> out = std::make_shared<State>();
+    out->visited = _visited;
+    return out;
+}
+
+template<class Maze>
+void AdvancedMoverT<Maze>::restoreState(const MoverState* state)
+{
+    const State* s = dynamic_cast<const State*>(state);
+    if(s)
+        _visited = s->visited;
+    else
+        _visited.clear();
+}
+
+template class AdvancedMoverT<maze<AdvancedMapTile>>;
+template class AdvancedMoverT<BlockedAdvancedMaze>;
+template class AdvancedMoverT<GuardedAdvancedMaze>;
+template class AdvancedMoverT<PackedAdvancedMaze>;
+template class AdvancedMoverT<ChunkedAdvancedMaze>;
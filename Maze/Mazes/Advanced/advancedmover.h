@@ -4,33 +4,103 @@
 #include "../../types.h"
 #include "../..//Interfaces/backend_types.h"
 #include "../../Interfaces/playermover.h"
+#include "../../Interfaces/mazebits.h"
+#include "../../Interfaces/packedplanes.h"
+#include "../../Interfaces/chunkedplanes.h"
 #include "../../attributeTypes.h"
 
+#include <cstdint>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
-class AdvancedMover : public PlayerMover<AdvancedPlayerData, AdvancedPlayerMove, AdvancedMapTile>
+//Maze is the maze moved through, built for maze<AdvancedMapTile>,
+//BlockedAdvancedMaze, GuardedAdvancedMaze, PackedAdvancedMaze and
+//ChunkedAdvancedMaze in advancedmover.cpp
+template<class Maze>
+class AdvancedMoverT final : public PlayerMover<AdvancedPlayerData, AdvancedPlayerMove, AdvancedMapTile, Maze>
 {
-    std::unordered_map<int, std::unordered_map<int, std::unordered_map<int, bool>>> _visited; //Map player to x to y to visited or not
+    //One bit per tile, row major, in chunks made the first time a tile in
+    //them is visited, kept by number so mazes too big to hold cost nothing
+    //for the chunks never reached. Copies share chunks, and a chunk is only copied when
+    //it is marked while shared, so saving the mover's state costs a pointer
+    //a chunk and each save after that only the chunks visited since
+    class VisitedTiles
+    {
+        enum : size_t {CHUNK_WORDS = 4096, CHUNK_TILES = CHUNK_WORDS*64};
+        typedef std::vector<uint64_t> Chunk;
+
+        size_t _tiles = 0;
+        std::unordered_map<size_t, std::shared_ptr<Chunk>> _chunks;
+
+    public:
+        size_t tiles() const {return _tiles;}
+
+        //Forgets every tile, for a maze of tiles tiles
+        void reset(size_t tiles)
+        {
+            _tiles = tiles;
+            _chunks.clear();
+        }
+
+        bool test(size_t tile) const
+        {
+            auto c = _chunks.find(tile/CHUNK_TILES);
+            return c != _chunks.end() && (*c->second)[tile%CHUNK_TILES/64] >> (tile%64) & 1;
+        }
+
+        void set(size_t tile)
+        {
+            std::shared_ptr<Chunk>& c = _chunks[tile/CHUNK_TILES];
+            if(!c) c = std::make_shared<Chunk>(CHUNK_WORDS, 0);
+            else if(c.use_count() > 1) c = std::make_shared<Chunk>(*c);
+            (*c)[tile%CHUNK_TILES/64] |= 1ull << (tile%64);
+        }
+    };
+
+    //Map player to the tiles they have visited
+    typedef std::unordered_map<int, VisitedTiles> VisitedMap;
+    VisitedMap _visited;
+
+    bool visited(int id, uint x, uint y, const Maze& m);
+    void markVisited(int id, uint x, uint y, const Maze& m);
+
+    struct State : public MoverState
+    {
+        VisitedMap visited;
+    };
 
     void performPlayerPendingMove(AdvancedPlayerData& playerData,
-                                  maze<AdvancedMapTile>& m);
+                                  Maze& m);
 
     void setupNextPlayerMove(AdvancedPlayerData& playerData,
                               const AdvancedPlayerMove& move,
-                              maze<AdvancedMapTile>& m);
+                              Maze& m);
 
     bool isValidMove(AdvancedPlayerData& playerData, 
                      const AdvancedPlayerMove& move,
-                     maze<AdvancedMapTile>& m);
+                     Maze& m);
 
     int moveLength(AdvancedPlayerData& playerData, 
                     const AdvancedPlayerMove& move,
-                    maze<AdvancedMapTile>& m);
+                    Maze& m);
+
+    bool adjacentAndConnected(Maze& m, const uint& x1, const uint& y1, const uint& x2, const uint& y2);
+    bool adjacentAndConnected(Maze& m, const MazePoint& p1, const MazePoint& p2);
 
-    bool adjacentAndConnected(maze<AdvancedMapTile>& m, const uint& x1, const uint& y1, const uint& x2, const uint& y2);
-    bool adjacentAndConnected(maze<AdvancedMapTile>& m, const MazePoint& p1, const MazePoint& p2);
+    //Open walls of the maze luck was last used in, kept up to date from the
+    //maze's journal so each use only floods instead of rebuilding them
+    MazeBits _bits;
+    MazeFlood _flood;
+    MazeJournal<AdvancedMapTile>::Cursor _bitsChanges;
 
-    MazePoint closestPointToExit(MazePoint current, maze<AdvancedMapTile>& m);
+    void updateBits(Maze& m);
+
+    //Tiles luck searches out from the exit on mazes too big to flood whole
+    //before giving up on finding the player
+    enum : size_t {LAZY_SEARCH_TILES = 1 << 20};
+
+    MazePoint closestPointToExit(MazePoint current, Maze& m);
 
 public:
     virtual AdvancedPlayerMove defaultMove()
@@ -40,7 +110,23 @@ public:
 
     void movePlayer(AdvancedPlayerData& playerData,
                      const AdvancedPlayerMove& move,
-                     maze<AdvancedMapTile>& m);
+                     Maze& m);
+
+    //Ticks above 1 are only counted down, the move happens when it reaches 1
+    unsigned int idleTicks(const AdvancedPlayerData& playerData)
+    {
+        return playerData.ticksLeftForCurrentMove > 1 ? playerData.ticksLeftForCurrentMove - 1 : 0;
+    }
+
+    void skipTicks(AdvancedPlayerData& playerData, unsigned int ticks)
+    {
+        playerData.ticksLeftForCurrentMove -= ticks;
+    }
+
+    std::shared_ptr<const MoverState> saveState();
+    void restoreState(const MoverState* state);
 };
 
+typedef AdvancedMoverT<maze<AdvancedMapTile>> AdvancedMover;
+
 #endif
\ No newline at end of file
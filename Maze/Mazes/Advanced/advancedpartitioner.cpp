@@ -1,12 +1,29 @@
 #include "advancedpartitioner.h"
-#include <exception>
+#include <algorithm>
 #include <cmath>
 
 using namespace std;
 
-AdvancedMapTile* AdvancedPartitioner::getMazeSection(unsigned int& width, unsigned int& height,
+//A tile is close enough when floor(sqrt(d2)) < vision, which is
+//d2 < vision^2, so each row of a section keeps one run of tiles round
+//the middle. Gives how far that run reaches either side of the middle,
+//counting the middle, or 0 for a row out of sight
+static unsigned int rowReach(long long vision2, long long row, unsigned int w2)
+{
+    long long left = vision2 - row*row;
+    if(left <= 0) return 0;
+
+    //Widest _j with _j*_j < left
+    unsigned int reach = std::sqrt((double)left);
+    while((long long)reach*reach >= left) reach--;
+    while((long long)(reach+1)*(reach+1) < left) reach++;
+    return std::min(reach, w2) + 1;
+}
+
+template<class Maze>
+AdvancedMapTile* AdvancedPartitionerT<Maze>::getMazeSection(unsigned int& width, unsigned int& height,
                             AdvancedPlayerData& player, point& relative_loc,
-                            maze<AdvancedMapTile>& m)
+                            Maze& m)
 {
     int maxSize = std::max(player.mapVisionDist, player.playerVisionDist)*2 + 1;
     int outSize = maxSize*maxSize;
@@ -19,53 +36,55 @@ AdvancedMapTile* AdvancedPartitioner::getMazeSection(unsigned int& width, unsign
     }
 
     AdvancedMapTile* outiter = _allocated[outSize];
-    auto initer = m.begin();
     unsigned int mwidth = m.width();
-    unsigned int mheight = m.height();
     unsigned int w2 = width/2;
     unsigned int h2 = height/2;
-    unsigned int y_start = target_loc.y-h2;
-    unsigned int x_start = target_loc.x-w2;
 
-    for(uint i=0, i_ = y_start; i<height; i++, i_++)
+    //They only get the whole tile if it's close enough, otherwise nothing or
+    //just the players added below, so only the run in sight is read
+    const AdvancedMapTile& outside = m.wall();
+    long long left = (long long)target_loc.x - w2;
+    long long mapVision2 = (long long)player.mapVisionDist*player.mapVisionDist;
+    for(uint i=0; i<height; i++, outiter += width)
+    {
+        unsigned int reach = rowReach(mapVision2, (long long)i - h2, w2);
+        unsigned int from = w2 + 1 - reach, to = w2 + reach;
+        if(reach == 0) from = to = width;
+        std::fill(outiter, outiter + from, outside);
+        m.readRow(left + from, (long long)target_loc.y + i - h2, to - from, outiter + from, outside);
+        std::fill(outiter + to, outiter + width, outside);
+    }
+
+    //Players come straight from the occupancy index, visible on any
+    //tile they would see the whole of or see players on. Only the tiles
+    //in sight are looked up, so this doesn't grow with the player count
+    AdvancedMapTile* out = _allocated[outSize];
+    int vision = std::max(player.mapVisionDist, player.playerVisionDist);
+    long long vision2 = (long long)vision*vision;
+    for(uint i=0; i<height; i++)
     {
-        int offset = i_*mwidth + (target_loc.x < w2 ? 0 : x_start);
-        initer = m.begin() + std::max(offset, 0);
+        long long _i = (long long)i - h2;
+        unsigned int reach = rowReach(vision2, _i, w2);
+        if(reach == 0) continue;
+
+        long long y = (long long)target_loc.y + _i;
+        if(!m.wrapped() && (y < 0 || y >= m.height())) continue;
+        unsigned int my = m.wrapY(y);
 
-        for(uint j=0, j_ = x_start; j<width; j++, j_++)
+        //A section wider than a wrapped maze sees tiles more than once,
+        //players are only shown at their nearest
+        if(wrappedDelta(target_loc.y, my, m.height(), m.wrapped()) != _i) continue;
+
+        for(long long _j = 1 - (long long)reach; _j < reach; _j++)
         {
-            int _i = i-h2;
-            int _j = j-w2;
-            int ptDist = sqrt(_j*_j+_i*_i);
-            if(i_ >= 0 && i_ < mheight && j_ >= 0 && j_ < mwidth)
-            {
-                //Check if they get the whole tile
-                if(ptDist < player.mapVisionDist)
-                {
-                    *outiter = *initer;
-                }
-                //Check if they get just the players and there are actually players
-                else if(ptDist < player.playerVisionDist && initer->players.size() > 0)
-                {
-                    *outiter = AdvancedMapTile();
-                    outiter->exits = 0;
-                    outiter->players = initer->players;
-                }
-                //They get nothing
-                else
-                {
-                    *outiter = AdvancedMapTile();
-                    outiter->exits = 0;
-                }
-                ++initer;
-            }
-            else
-            {
-                *outiter = AdvancedMapTile();
-                outiter->exits = 0;
-            }
+            long long x = (long long)target_loc.x + _j;
+            if(!m.wrapped() && (x < 0 || x >= mwidth)) continue;
+            unsigned int mx = m.wrapX(x);
+            if(wrappedDelta(target_loc.x, mx, mwidth, m.wrapped()) != _j) continue;
 
-            ++outiter;
+            size_t tile = m.index(mx, my);
+            for(unsigned int p = m.occupants.first(tile); p != OccupancyIndex::NONE; p = m.occupants.next(p))
+                out[i*width + _j+w2].players.push_back(p);
         }
     }
 
@@ -73,3 +92,9 @@ AdvancedMapTile* AdvancedPartitioner::getMazeSection(unsigned int& width, unsign
 
     return _allocated[outSize];
 }
+
+template class AdvancedPartitionerT<maze<AdvancedMapTile>>;
+template class AdvancedPartitionerT<BlockedAdvancedMaze>;
+template class AdvancedPartitionerT<GuardedAdvancedMaze>;
+template class AdvancedPartitionerT<PackedAdvancedMaze>;
+template class AdvancedPartitionerT<ChunkedAdvancedMaze>;
@@ -4,15 +4,20 @@
 #include "../../types.h"
 #include "../../Interfaces/backend_types.h"
 #include "../../Interfaces/mazepartitioner.h"
+#include "../../Interfaces/packedplanes.h"
+#include "../../Interfaces/chunkedplanes.h"
 #include "../../attributeTypes.h"
 #include <unordered_map>
 
-class AdvancedPartitioner : public MazePartitioner<AdvancedPlayerData, AdvancedMapTile>
+//Built for maze<AdvancedMapTile>, BlockedAdvancedMaze, GuardedAdvancedMaze,
+//PackedAdvancedMaze and ChunkedAdvancedMaze in advancedpartitioner.cpp
+template<class Maze>
+class AdvancedPartitionerT final : public MazePartitioner<AdvancedPlayerData, AdvancedMapTile, Maze>
 {
     std::unordered_map<int, AdvancedMapTile*> _allocated;
     
 public:
-    ~AdvancedPartitioner()
+    ~AdvancedPartitionerT()
     {
         for(auto p : _allocated)
             delete[] p.second;
@@ -20,7 +25,9 @@ public:
     
     virtual AdvancedMapTile* getMazeSection(unsigned int& width, unsigned int& height,
                             AdvancedPlayerData& player, point& relative_loc,
-                            maze<AdvancedMapTile>& m);
+                            Maze& m);
 };
 
+typedef AdvancedPartitionerT<maze<AdvancedMapTile>> AdvancedPartitioner;
+
 #endif
\ No newline at end of file
@@ -5,7 +5,8 @@ using namespace std;
 
 constexpr int ATTRIBUTE_POINTS = 10;
 
-void AdvancedRules::fillPlayerDataFromAttributes(PlayerAttributes attrib, AdvancedPlayerData& data)
+template<class Maze>
+void AdvancedRulesT<Maze>::fillPlayerDataFromAttributes(PlayerAttributes attrib, AdvancedPlayerData& data)
 {
     //Putting 3 points into speed or intelligence gets 1 bonus in that area
     //and -1 in the other
@@ -22,12 +23,14 @@ void AdvancedRules::fillPlayerDataFromAttributes(PlayerAttributes attrib, Advanc
     data.moveInProgress.attemptedMove = AdvancedPlayerMove::Move::NOOP;
 }
 
-MazeSettings AdvancedRules::getSettings(const maze<AdvancedMapTile>& m)
+template<class Maze>
+MazeSettings AdvancedRulesT<Maze>::getSettings(const Maze& m)
 {
     return MazeSettings(m.width(), m.height(), m.wrapped(), m.exit.x, m.exit.y);
 }
 
-AdvancedPlayerData AdvancedRules::initPlayer(AttributePlayer* player, maze<AdvancedMapTile>& m)
+template<class Maze>
+AdvancedPlayerData AdvancedRulesT<Maze>::initPlayer(AttributePlayer* player, Maze& m)
 {
     AdvancedPlayerData out;
     if(_playerIds.find(player) != _playerIds.end())
@@ -43,10 +46,7 @@ AdvancedPlayerData AdvancedRules::initPlayer(AttributePlayer* player, maze<Advan
     }
     else out = AdvancedPlayerData{0,0, -1};
 
-    if(out.id >= 0)
-    {
-        m.at(out.x, out.y).players.push_back(out.id);
-    }
+    placePlayer(out, m);
 
     PlayerAttributes p = player->getAttributes(ATTRIBUTE_POINTS);
 
@@ -73,12 +73,18 @@ AdvancedPlayerData AdvancedRules::initPlayer(AttributePlayer* player, maze<Advan
     return out;
 }
 
-bool AdvancedRules::playerGetsTurn(AdvancedPlayerData playerData, const maze<AdvancedMapTile>& m)
+template<class Maze>
+void AdvancedRulesT<Maze>::placePlayer(const AdvancedPlayerData& playerData, Maze& m)
 {
-    return playerData.ticksLeftForCurrentMove == 0;
+    //Players off the edge, after phasing through the outer wall, stand on no tile
+    if(playerData.id >= 0 && playerData.x < m.width() && playerData.y < m.height())
+    {
+        m.occupants.place(playerData.id, m.index(playerData.x, playerData.y));
+    }
 }
 
-bool AdvancedRules::playerIsDone(AdvancedPlayerData playerData, const maze<AdvancedMapTile>& m)
-{
-    return playerData.x == m.exit.x && playerData.y == m.exit.y;
-}
+template class AdvancedRulesT<maze<AdvancedMapTile>>;
+template class AdvancedRulesT<BlockedAdvancedMaze>;
+template class AdvancedRulesT<GuardedAdvancedMaze>;
+template class AdvancedRulesT<PackedAdvancedMaze>;
+template class AdvancedRulesT<ChunkedAdvancedMaze>;
@@ -6,9 +6,14 @@
 #include "../../attributeTypes.h"
 #include "../../Interfaces/attributePlayer.h"
 #include "../../Interfaces/backend_types.h"
+#include "../../Interfaces/packedplanes.h"
+#include "../../Interfaces/chunkedplanes.h"
 #include<unordered_map>
 
-class AdvancedRules : public RuleEnforcer<AttributePlayer, AdvancedPlayerData, AdvancedMapTile>
+//Built for maze<AdvancedMapTile>, BlockedAdvancedMaze, GuardedAdvancedMaze,
+//PackedAdvancedMaze and ChunkedAdvancedMaze in advancedrules.cpp
+template<class Maze>
+class AdvancedRulesT final : public RuleEnforcer<AttributePlayer, AdvancedPlayerData, AdvancedMapTile, Maze>
 {
     std::unordered_map<AttributePlayer*, unsigned int> _playerIds;
     uint playerCount = 0;
@@ -19,10 +24,22 @@ public:
     {
         return (before.x != after.x) || (before.y != after.y);
     }
-    MazeSettings getSettings(const maze<AdvancedMapTile>& m);
-    AdvancedPlayerData initPlayer(AttributePlayer* player, maze<AdvancedMapTile>& m);
-    bool playerGetsTurn(AdvancedPlayerData playerData, const maze<AdvancedMapTile>& m);
-    bool playerIsDone(AdvancedPlayerData playerData, const maze<AdvancedMapTile>& m);
+    MazeSettings getSettings(const Maze& m);
+    AdvancedPlayerData initPlayer(AttributePlayer* player, Maze& m);
+    void placePlayer(const AdvancedPlayerData& playerData, Maze& m);
+
+    bool playerGetsTurn(const AdvancedPlayerData& playerData, const Maze& m)
+    {
+        return playerData.ticksLeftForCurrentMove == 0;
+    }
+
+    //Off the maze is a wall, never the exit
+    bool playerIsDone(const AdvancedPlayerData& playerData, const Maze& m)
+    {
+        return m.flag(MAZE_FLAG_EXIT, playerData.x, playerData.y);
+    }
 };
 
+typedef AdvancedRulesT<maze<AdvancedMapTile>> AdvancedRules;
+
 #endif
@@ -0,0 +1,205 @@
+#include "blockgenerator.h"
+#include "../../Interfaces/mazebits.h"
+#include "../../Interfaces/tileuids.h"
+#include "../../workerpool.h"
+
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+template<class Maze>
+Maze BlockGeneratorT<Maze>::generateMaze(unsigned int players, MazeRandom& rng)
+{
+    cerr << "Generating Maze..." << endl;
+
+    _maze = Maze(_w, _h, false);
+    _maze.deriveUids(TileUids(rng.next()));
+    uint64_t seed = (uint64_t)rng.next() << 32 | rng.next();
+
+    unsigned int blocksWide = (_w + _side - 1)/_side;
+    unsigned int blocksHigh = (_h + _side - 1)/_side;
+
+    //Blocks are carved apart and only copied in one at a time
+    {
+        unsigned int threads = _threads ? _threads : thread::hardware_concurrency();
+        WorkerPool pool(threads);
+        for(unsigned int by=0; by<blocksHigh; by++)
+        {
+            for(unsigned int bx=0; bx<blocksWide; bx++)
+            {
+                pool.push([this, bx, by, seed](){_carveBlock(bx, by, seed);});
+            }
+        }
+        pool.wait();
+    }
+
+    //Random spanning tree over the blocks, Kruskal's over shuffled edges
+    //Edges are numbered block*2 for the one east of it, block*2+1 south
+    unsigned int blocks = blocksWide*blocksHigh;
+    vector<unsigned int> edges;
+    for(unsigned int b=0; b<blocks; b++)
+    {
+        if(b%blocksWide + 1 < blocksWide) edges.push_back(b*2);
+        if(b/blocksWide + 1 < blocksHigh) edges.push_back(b*2 + 1);
+    }
+    for(size_t i=edges.size(); i>1; i--)
+        swap(edges[i-1], edges[rng.below(i)]);
+
+    vector<unsigned int> parent(blocks);
+    for(unsigned int b=0; b<blocks; b++)
+        parent[b] = b;
+    auto find = [&parent](unsigned int b)
+    {
+        while(parent[b] != b)
+        {
+            parent[b] = parent[parent[b]];
+            b = parent[b];
+        }
+        return b;
+    };
+
+    for(unsigned int e : edges)
+    {
+        unsigned int a = e/2;
+        bool east = e%2 == 0;
+        unsigned int b = east ? a+1 : a+blocksWide;
+        unsigned int ra = find(a), rb = find(b);
+        if(ra == rb) continue;
+        parent[ra] = rb;
+
+        //Door at a random tile along the border the blocks share
+        unsigned int bx = a%blocksWide, by = a/blocksWide;
+        if(east)
+        {
+            unsigned int x = (bx+1)*_side - 1;
+            unsigned int y = by*_side + rng.below(min(_side, _h - by*_side));
+            _connectTiles(point{x, y}, point{x+1, y});
+        }
+        else
+        {
+            unsigned int x = bx*_side + rng.below(min(_side, _w - bx*_side));
+            unsigned int y = (by+1)*_side - 1;
+            _connectTiles(point{x, y}, point{x, y+1});
+        }
+    }
+
+    Maze out = _maze;
+    _maze = Maze();
+
+    out.exit = point{rng.below(_w), rng.below(_h)};
+    out.setFlag(MAZE_FLAG_EXIT, out.exit, true);
+
+    out.players = pickStarts(farStartLayer(MazeBits(out), out.exit, players, rng), players, rng);
+
+    cout << "Done!" << endl;
+
+    return out;
+}
+
+template<class Maze>
+void BlockGeneratorT<Maze>::_carveBlock(unsigned int bx, unsigned int by, uint64_t seed)
+{
+
+    MazeRandom rng(seed, (uint64_t)by*((_w + _side - 1)/_side) + bx);
+    unsigned int left = bx*_side, top = by*_side;
+    unsigned int right = min(_w, left + _side), bottom = min(_h, top + _side);
+
+    //Carved into a block of its own first. Storages may pack tiles of
+    //neighbouring blocks into the same bytes, so only the copy into the
+    //maze below is done one block at a time
+    unsigned int bw = right - left, bh = bottom - top;
+    vector<unsigned char> block((size_t)bw*bh, 0);
+    auto exits = [&](const point& p) -> unsigned char& {return block[(size_t)bw*(p.y - top) + p.x - left];};
+    auto connect = [&](const point& a, const point& b)
+    {
+        unsigned char dir, back;
+        if(b.x > a.x) {dir = (unsigned char)AdvancedMapTile::Direction::EAST; back = (unsigned char)AdvancedMapTile::Direction::WEST;}
+        else if(b.x < a.x) {dir = (unsigned char)AdvancedMapTile::Direction::WEST; back = (unsigned char)AdvancedMapTile::Direction::EAST;}
+        else if(b.y > a.y) {dir = (unsigned char)AdvancedMapTile::Direction::SOUTH; back = (unsigned char)AdvancedMapTile::Direction::NORTH;}
+        else {dir = (unsigned char)AdvancedMapTile::Direction::NORTH; back = (unsigned char)AdvancedMapTile::Direction::SOUTH;}
+        exits(a) |= dir;
+        exits(b) |= back;
+    };
+
+    //Same walk as AdvancedGenerator, kept inside the block
+    //A tile with no exits hasn't been visited yet
+    vector<point> retrace;
+    retrace.push_back(point{left, top});
+    while(retrace.size())
+    {
+        point curr = retrace.back();
+        point dirs[4];
+        unsigned int count = 0;
+        if(curr.x > left && exits(point{curr.x-1, curr.y}) == 0) dirs[count++] = point{curr.x-1, curr.y};
+        if(curr.x+1 < right && exits(point{curr.x+1, curr.y}) == 0) dirs[count++] = point{curr.x+1, curr.y};
+        if(curr.y > top && exits(point{curr.x, curr.y-1}) == 0) dirs[count++] = point{curr.x, curr.y-1};
+        if(curr.y+1 < bottom && exits(point{curr.x, curr.y+1}) == 0) dirs[count++] = point{curr.x, curr.y+1};
+
+        if(count == 0)
+        {
+            retrace.pop_back();
+            continue;
+        }
+
+        point next = dirs[rng.below(count)];
+        connect(curr, next);
+        retrace.push_back(next);
+    }
+
+    //Extra openings east and south, but not across the block's edges
+    if(_cycles > 0)
+    {
+        for(unsigned int y=top; y<bottom; y++)
+        {
+            for(unsigned int x=left; x<right; x++)
+            {
+                if(rng.below(100) >= _cycles) continue;
+                if(x+1 < right && rng.below(100) > 50)
+                    connect(point{x, y}, point{x+1, y});
+                if(y+1 < bottom && rng.below(100) > 50)
+                    connect(point{x, y}, point{x, y+1});
+            }
+        }
+    }
+
+    lock_guard<mutex> lock(_write);
+    for(unsigned int y=top; y<bottom; y++)
+        for(unsigned int x=left; x<right; x++)
+            _maze.setExits(x, y, exits(point{x, y}));
+}
+
+template<class Maze>
+void BlockGeneratorT<Maze>::_connectTiles(const point& a, const point& b)
+{
+    long long dx = (long long)b.x - (long long)a.x;
+    long long dy = (long long)b.y - (long long)a.y;
+    if(dx == 1 && dy == 0)
+    {
+        _maze.addExits(a.x, a.y, (unsigned char)AdvancedMapTile::Direction::EAST);
+        _maze.addExits(b.x, b.y, (unsigned char)AdvancedMapTile::Direction::WEST);
+    }
+    else if(dx == -1 && dy == 0)
+    {
+        _maze.addExits(a.x, a.y, (unsigned char)AdvancedMapTile::Direction::WEST);
+        _maze.addExits(b.x, b.y, (unsigned char)AdvancedMapTile::Direction::EAST);
+    }
+    else if(dx == 0 && dy == 1)
+    {
+        _maze.addExits(a.x, a.y, (unsigned char)AdvancedMapTile::Direction::SOUTH);
+        _maze.addExits(b.x, b.y, (unsigned char)AdvancedMapTile::Direction::NORTH);
+    }
+    else if(dx == 0 && dy == -1)
+    {
+        _maze.addExits(a.x, a.y, (unsigned char)AdvancedMapTile::Direction::NORTH);
+        _maze.addExits(b.x, b.y, (unsigned char)AdvancedMapTile::Direction::SOUTH);
+    }
+}
+
+template class BlockGeneratorT<maze<AdvancedMapTile>>;
+template class BlockGeneratorT<BlockedAdvancedMaze>;
+template class BlockGeneratorT<GuardedAdvancedMaze>;
+template class BlockGeneratorT<PackedAdvancedMaze>;
@@ -0,0 +1,53 @@
+#ifndef _BLOCK_GEN_H
+#define _BLOCK_GEN_H
+
+#include "../../Interfaces/mazegenerator.h"
+#include "../../types.h"
+#include "../../attributeTypes.h"
+#include "../../Interfaces/backend_types.h"
+#include "../../Interfaces/packedplanes.h"
+
+#include <cstdint>
+#include <mutex>
+
+//Generates a maze in square blocks, several at once on worker threads
+//Each block is a depth first maze of its own, drawn from a random stream
+//picked by the block's position, so the maze comes out the same for any
+//number of threads. The blocks are then joined by one passage for every
+//edge of a random spanning tree over them, which keeps every tile connected
+//to every other by exactly one path. Loops are only added inside blocks,
+//where no other thread is working, when percentCycles is above 0
+//Built for maze<AdvancedMapTile>, BlockedAdvancedMaze, GuardedAdvancedMaze,
+//and PackedAdvancedMaze in blockgenerator.cpp
+template<class Maze>
+class BlockGeneratorT final : public MazeGenerator<AdvancedMapTile, Maze>
+{
+    unsigned int _w, _h;
+    double _cycles;
+    unsigned int _threads;
+    unsigned int _side;
+
+    Maze _maze;
+
+    //Held while a carved block is copied into _maze
+    std::mutex _write;
+
+    //Carves block bx, by from its own stream
+    void _carveBlock(unsigned int bx, unsigned int by, uint64_t seed);
+
+    void _connectTiles(const point& a, const point& b);
+
+public:
+    //threads of 0 uses one for each core
+    BlockGeneratorT(int width, int height, double percentCycles = 0, unsigned int threads = 0, unsigned int blockSide = 256) :
+        _w(width), _h(height), _cycles(percentCycles), _threads(threads), _side(blockSide ? blockSide : 1){}
+
+    Maze generateMaze(unsigned int players, MazeRandom& rng);
+
+    //Returns whether or not the maze wraps around on the edges
+    bool isWrapped(){return false;}
+};
+
+typedef BlockGeneratorT<maze<AdvancedMapTile>> BlockGenerator;
+
+#endif
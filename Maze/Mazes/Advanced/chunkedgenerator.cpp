@@ -0,0 +1,26 @@
+#include "chunkedgenerator.h"
+#include "../../Interfaces/mazebits.h"
+#include "../../Interfaces/tileuids.h"
+
+#include <iostream>
+
+using namespace std;
+
+ChunkedAdvancedMaze ChunkedGenerator::generateMaze(unsigned int players, MazeRandom& rng)
+{
+    cerr << "Generating Maze..." << endl;
+
+    ChunkedAdvancedMaze out(_w, _h, false);
+    uint64_t seed = rng.next();
+    out.storage().generate(seed << 32 | rng.next(), _maxChunks);
+    out.deriveUids(TileUids(rng.next()));
+
+    out.exit = point{rng.below(_w), rng.below(_h)};
+    out.setFlag(MAZE_FLAG_EXIT, out.exit, true);
+
+    out.players = pickStarts(nearStartLayer(out, out.exit, players, _searchTiles, rng), players, rng);
+
+    cout << "Done!" << endl;
+
+    return out;
+}
@@ -0,0 +1,33 @@
+#ifndef _CHUNKED_GEN_H
+#define _CHUNKED_GEN_H
+
+#include "../../Interfaces/mazegenerator.h"
+#include "../../types.h"
+#include "../../attributeTypes.h"
+#include "../../Interfaces/backend_types.h"
+#include "../../Interfaces/chunkedplanes.h"
+
+#include <cstddef>
+
+//Makes mazes too big to generate up front, see ChunkedPlanes
+//generateMaze only picks the seed, the exit and the starts. Chunks are
+//drawn the first time a tile in them is read, and no more than maxChunks
+//are kept at once, 0 for no limit. The maze can't be flooded whole, so
+//starts come from the furthest layers a search of searchTiles tiles out
+//from the exit reaches. The maze never wraps
+class ChunkedGenerator final : public MazeGenerator<AdvancedMapTile, ChunkedAdvancedMaze>
+{
+    unsigned int _w, _h;
+    size_t _maxChunks, _searchTiles;
+
+public:
+    ChunkedGenerator(int width, int height, size_t maxChunks = 0, size_t searchTiles = 1 << 16) :
+        _w(width), _h(height), _maxChunks(maxChunks), _searchTiles(searchTiles){}
+
+    ChunkedAdvancedMaze generateMaze(unsigned int players, MazeRandom& rng);
+
+    //Returns whether or not the maze wraps around on the edges
+    bool isWrapped(){return false;}
+};
+
+#endif
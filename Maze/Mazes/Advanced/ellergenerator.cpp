@@ -0,0 +1,199 @@
+#include "ellergenerator.h"
+#include "../../Interfaces/mazebits.h"
+#include "../../Interfaces/tileuids.h"
+#include "../../mazefile.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+template<class Maze>
+void EllerGeneratorT<Maze>::generateRows(MazeRandom& rng, const function<void(unsigned int, const unsigned char*)>& emit)
+{
+    const unsigned int NONE = ~0u;
+
+    //Set ids are renumbered every row, so they stay below twice the width
+    //Sets joined along a row are merged through a union find over those ids
+    vector<unsigned int> set(_w, NONE);
+    //Set of the tile above each one, in this row's numbering
+    vector<unsigned int> above(_w, NONE);
+    vector<unsigned int> parent(2*_w), remaining(2*_w, 0), renumber(2*_w, NONE);
+    vector<bool> goesDown(2*_w, false);
+    //A row is handed on once the row below it is joined up, since loops
+    //can still open walls between the two
+    vector<unsigned char> prev(_w, 0), row(_w, 0), below(_w, 0);
+    unsigned int sets = 0;
+
+    auto find = [&parent](unsigned int s)
+    {
+        while(parent[s] != s)
+        {
+            parent[s] = parent[parent[s]];
+            s = parent[s];
+        }
+        return s;
+    };
+
+    for(unsigned int y=0; y<_h; y++)
+    {
+        bool last = y+1 == _h;
+
+        //Tiles nothing came down into start sets of their own
+        for(unsigned int x=0; x<_w; x++)
+            if(set[x] == NONE) set[x] = sets++;
+        for(unsigned int s=0; s<sets; s++)
+            parent[s] = s;
+
+        //Join neighbours in different sets at random, or all of them on the
+        //last row so everything ends up connected
+        for(unsigned int x=0; x+1<_w; x++)
+        {
+            unsigned int a = find(set[x]), b = find(set[x+1]);
+            bool open;
+            if(a != b)
+            {
+                open = last || rng.below(2);
+                if(open) parent[a] = b;
+            }
+            else
+                open = _cycles > 0 && rng.below(100) < _cycles;
+
+            if(open)
+            {
+                row[x] |= (unsigned char)AdvancedMapTile::Direction::EAST;
+                row[x+1] |= (unsigned char)AdvancedMapTile::Direction::WEST;
+            }
+        }
+
+        //Loops up through walls between tiles the row joined into one set
+        if(_cycles > 0 && y > 0)
+        {
+            for(unsigned int x=0; x<_w; x++)
+            {
+                if(row[x] & (unsigned char)AdvancedMapTile::Direction::NORTH) continue;
+                if(find(set[x]) != find(above[x]) || rng.below(100) >= _cycles) continue;
+                row[x] |= (unsigned char)AdvancedMapTile::Direction::NORTH;
+                prev[x] |= (unsigned char)AdvancedMapTile::Direction::SOUTH;
+            }
+        }
+        if(y > 0) emit(y-1, prev.data());
+
+        if(!last)
+        {
+            for(unsigned int x=0; x<_w; x++)
+            {
+                set[x] = find(set[x]);
+                remaining[set[x]]++;
+            }
+
+            //Every set goes down at least once, from its last tile if no other
+            for(unsigned int x=0; x<_w; x++)
+            {
+                unsigned int s = set[x];
+                remaining[s]--;
+                bool down = rng.below(2) || (remaining[s] == 0 && !goesDown[s]);
+                above[x] = s;
+
+                if(down)
+                {
+                    goesDown[s] = true;
+                    row[x] |= (unsigned char)AdvancedMapTile::Direction::SOUTH;
+                    below[x] |= (unsigned char)AdvancedMapTile::Direction::NORTH;
+                }
+                else
+                    set[x] = NONE;
+            }
+
+            //Renumber what carries down from 0
+            for(unsigned int s=0; s<sets; s++)
+                goesDown[s] = false;
+            sets = 0;
+            for(unsigned int x=0; x<_w; x++)
+            {
+                if(set[x] == NONE) continue;
+                if(renumber[set[x]] == NONE) renumber[set[x]] = sets++;
+                set[x] = renumber[set[x]];
+            }
+            //Every set went down somewhere, so every tile above has a number
+            for(unsigned int x=0; x<_w; x++)
+                above[x] = renumber[above[x]];
+            std::fill(renumber.begin(), renumber.end(), NONE);
+        }
+
+        if(last) emit(y, row.data());
+        prev.swap(row);
+        row.swap(below);
+        std::fill(below.begin(), below.end(), 0);
+    }
+}
+
+template<class Maze>
+Maze EllerGeneratorT<Maze>::generateMaze(unsigned int players, MazeRandom& rng)
+{
+    cerr << "Generating Maze..." << endl;
+
+    Maze out(_w, _h, false);
+    out.deriveUids(TileUids(rng.next()));
+    generateRows(rng, [&](unsigned int y, const unsigned char* exits)
+    {
+        for(unsigned int x=0; x<_w; x++)
+            out.setExits(x, y, exits[x]);
+    });
+
+    out.exit = point{rng.below(_w), rng.below(_h)};
+    out.setFlag(MAZE_FLAG_EXIT, out.exit, true);
+
+    out.players = pickStarts(farStartLayer(MazeBits(out), out.exit, players, rng), players, rng);
+
+    cout << "Done!" << endl;
+
+    return out;
+}
+
+template<class Maze>
+bool EllerGeneratorT<Maze>::generateFile(const string& path, unsigned int players, MazeRandom& rng)
+{
+    MazeFileWriter file;
+    if(!file.open(path, _w, _h, false, true, players))
+        return false;
+
+    TileUids uids(rng.next());
+    vector<uint32_t> uidRow(_w);
+    generateRows(rng, [&](unsigned int y, const unsigned char* exits)
+    {
+        for(unsigned int x=0; x<_w; x++)
+            uidRow[x] = uids((uint64_t)_w*y + x);
+        file.writeRow(exits, uidRow.data());
+    });
+
+    //The maze is never held whole here, so there's no flood from the exit
+    //to pick far starts from like generateMaze does. Streamed files get
+    //uniform starts instead, kept off the exit and the tiles beside it
+    //while the maze has room elsewhere
+    point exit = point{rng.below(_w), rng.below(_h)};
+    size_t cells = (size_t)_w*_h;
+    size_t nearby = 1 + (exit.x > 0) + (exit.x + 1 < _w) + (exit.y > 0) + (exit.y + 1 < _h);
+    //Distance from the exit starts must be beyond, -1 for anywhere
+    long long keepOff = cells > nearby ? 1 : cells > 1 ? 0 : -1;
+    vector<point> starts;
+    for(unsigned int i=0; i<players; i++)
+    {
+        point p;
+        do
+        {
+            p = point{rng.below(_w), rng.below(_h)};
+        }while(std::abs((long long)p.x - (long long)exit.x) + std::abs((long long)p.y - (long long)exit.y) <= keepOff);
+        starts.push_back(p);
+    }
+
+    //The stream isn't recorded, MazeFileGenerator would otherwise take this
+    //for a maze generateMaze made, starts and all
+    return file.close(exit, starts);
+}
+
+template class EllerGeneratorT<maze<AdvancedMapTile>>;
+template class EllerGeneratorT<BlockedAdvancedMaze>;
+template class EllerGeneratorT<GuardedAdvancedMaze>;
+template class EllerGeneratorT<PackedAdvancedMaze>;
@@ -0,0 +1,50 @@
+#ifndef _ELLER_GEN_H
+#define _ELLER_GEN_H
+
+#include "../../Interfaces/mazegenerator.h"
+#include "../../types.h"
+#include "../../attributeTypes.h"
+#include "../../Interfaces/backend_types.h"
+#include "../../Interfaces/packedplanes.h"
+
+#include <functional>
+#include <string>
+
+//Generates a maze a row at a time with Eller's algorithm
+//Only three rows and a couple of set ids per column are kept, so the
+//working memory grows with the width and not the area. Rows can be handed
+//on as they are finished, straight into a maze file, for mazes far too big
+//to hold. Every tile is connected to every other. When percentCycles is
+//above 0 that percentage of the walls between tiles already joined, along
+//a row or up to the row above, are opened as well to make loops
+//Built for maze<AdvancedMapTile>, BlockedAdvancedMaze, GuardedAdvancedMaze,
+//and PackedAdvancedMaze in ellergenerator.cpp
+template<class Maze>
+class EllerGeneratorT final : public MazeGenerator<AdvancedMapTile, Maze>
+{
+    unsigned int _w, _h;
+    double _cycles;
+
+public:
+    EllerGeneratorT(int width, int height, double percentCycles = 0) : _w(width), _h(height), _cycles(percentCycles){}
+
+    //Calls row(y, exits) for every row from the top, exits holding its _w tiles
+    //exits is only valid during the call
+    void generateRows(MazeRandom& rng, const std::function<void(unsigned int, const unsigned char*)>& row);
+
+    //Builds the whole maze in memory, see generateFile for mazes too big to hold
+    Maze generateMaze(unsigned int players, MazeRandom& rng);
+
+    //Writes the tiles generateMaze would make from rng to a maze file,
+    //without holding more than a couple of rows
+    //Finding starts far from the exit needs the whole maze, so they are
+    //random tiles instead. Returns false if the file could not be written
+    bool generateFile(const std::string& path, unsigned int players, MazeRandom& rng);
+
+    //Returns whether or not the maze wraps around on the edges
+    bool isWrapped(){return false;}
+};
+
+typedef EllerGeneratorT<maze<AdvancedMapTile>> EllerGenerator;
+
+#endif
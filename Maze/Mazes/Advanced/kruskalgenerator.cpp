@@ -0,0 +1,186 @@
+#include "kruskalgenerator.h"
+#include "../../Interfaces/mazebits.h"
+#include "../../Interfaces/tileuids.h"
+#include "../../workerpool.h"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+//Wall slots each shuffle job deals out, and the buckets they are dealt into
+//Both are fixed so the order doesn't depend on the number of threads
+static const size_t DEAL_SLOTS = 1 << 20;
+static const unsigned int BUCKETS = 64;
+
+//Walls looked up together in the union phase
+static const size_t BATCH = 16;
+
+//Calls place(bucket, wall) for every wall in the slots of one shuffle job,
+//slots numbered like walls, skipping those past the east and south edges
+template<class Place>
+static void dealWalls(size_t job, unsigned int w, unsigned int h, uint64_t seed, Place place)
+{
+    MazeRandom rng(seed, job);
+    size_t end = min((size_t)w*h*2, (job+1)*DEAL_SLOTS);
+    for(size_t slot = job*DEAL_SLOTS; slot < end; slot++)
+    {
+        size_t tile = slot/2;
+        bool south = slot%2;
+        if(south ? tile/w + 1 >= h : tile%w + 1 >= w) continue;
+        place(rng.below(BUCKETS), (uint32_t)slot);
+    }
+}
+
+template<class Maze>
+vector<uint32_t> KruskalGeneratorT<Maze>::_shuffledWalls(MazeRandom& rng)
+{
+    //Shuffled in parallel by dealing every wall into a random bucket, then
+    //shuffling each bucket on its own. Each job has its own stream, and
+    //deals the same way twice, once to count and once to place
+    uint64_t dealSeed = (uint64_t)rng.next() << 32 | rng.next();
+    uint64_t shuffleSeed = (uint64_t)rng.next() << 32 | rng.next();
+
+    size_t slots = (size_t)_w*_h*2;
+    size_t jobs = (slots + DEAL_SLOTS - 1)/DEAL_SLOTS;
+    vector<size_t> counts(jobs*BUCKETS, 0);
+
+    unsigned int threads = _threads ? _threads : thread::hardware_concurrency();
+    WorkerPool pool(threads);
+    for(size_t j=0; j<jobs; j++)
+    {
+        pool.push([this, &counts, dealSeed, j]()
+        {
+            size_t* count = &counts[j*BUCKETS];
+            dealWalls(j, _w, _h, dealSeed, [count](unsigned int bucket, uint32_t){count[bucket]++;});
+        });
+    }
+    pool.wait();
+
+    //Buckets one after another, each job's walls in job order within them
+    vector<size_t> offsets(jobs*BUCKETS), bucketStart(BUCKETS + 1, 0);
+    size_t at = 0;
+    for(unsigned int b=0; b<BUCKETS; b++)
+    {
+        bucketStart[b] = at;
+        for(size_t j=0; j<jobs; j++)
+        {
+            offsets[j*BUCKETS + b] = at;
+            at += counts[j*BUCKETS + b];
+        }
+    }
+    bucketStart[BUCKETS] = at;
+
+    vector<uint32_t> out(at);
+    for(size_t j=0; j<jobs; j++)
+    {
+        pool.push([this, &offsets, &out, dealSeed, j]()
+        {
+            size_t* next = &offsets[j*BUCKETS];
+            uint32_t* walls = out.data();
+            dealWalls(j, _w, _h, dealSeed, [next, walls](unsigned int bucket, uint32_t slot){walls[next[bucket]++] = slot;});
+        });
+    }
+    pool.wait();
+
+    for(unsigned int b=0; b<BUCKETS; b++)
+    {
+        pool.push([&out, &bucketStart, shuffleSeed, b]()
+        {
+            MazeRandom bucketRng(shuffleSeed, b);
+            uint32_t* walls = out.data() + bucketStart[b];
+            size_t n = bucketStart[b+1] - bucketStart[b];
+            for(size_t i=n; i>1; i--)
+                swap(walls[i-1], walls[bucketRng.below(i)]);
+        });
+    }
+    pool.wait();
+
+    return out;
+}
+
+template<class Maze>
+Maze KruskalGeneratorT<Maze>::generateMaze(unsigned int players, MazeRandom& rng)
+{
+    cerr << "Generating Maze..." << endl;
+
+
+    Maze out(_w, _h, false);
+    out.deriveUids(TileUids(rng.next()));
+
+    vector<uint32_t> walls = _shuffledWalls(rng);
+
+    //Rank keeps the trees shallow, so finds touch few of the scattered tiles
+    vector<uint32_t> parent((size_t)_w*_h);
+    vector<unsigned char> rank(parent.size(), 0);
+    for(size_t i=0; i<parent.size(); i++)
+        parent[i] = i;
+
+    //Path halving, every other step on the way up skips to its grandparent
+    auto find = [&parent](uint32_t t)
+    {
+        while(parent[t] != t)
+        {
+            parent[t] = parent[parent[t]];
+            t = parent[t];
+        }
+        return t;
+    };
+
+    //The tiles either side of shuffled walls are all over the maze, so each
+    //batch fetches the parents it will need before any of them are used
+    size_t joins = 0, tiles = parent.size();
+    for(size_t start=0; start<walls.size() && (joins+1 < tiles || _cycles > 0); start+=BATCH)
+    {
+        size_t end = min(walls.size(), start + BATCH);
+        for(size_t i=start; i<end; i++)
+        {
+            uint32_t a = walls[i]/2, b = walls[i]%2 ? a + _w : a + 1;
+            __builtin_prefetch(&parent[a]);
+            __builtin_prefetch(&parent[b]);
+        }
+
+        for(size_t i=start; i<end; i++)
+        {
+            bool south = walls[i]%2;
+            uint32_t a = walls[i]/2, b = south ? a + _w : a + 1;
+            uint32_t ra = find(a), rb = find(b);
+            if(ra != rb)
+            {
+                if(rank[ra] > rank[rb]) swap(ra, rb);
+                parent[ra] = rb;
+                if(rank[ra] == rank[rb]) rank[rb]++;
+                joins++;
+            }
+            else if(_cycles <= 0 || rng.below(100) >= _cycles)
+                continue;
+
+            unsigned int x = a % _w, y = a / _w;
+            if(south)
+            {
+                out.addExits(x, y, (unsigned char)AdvancedMapTile::Direction::SOUTH);
+                out.addExits(x, y+1, (unsigned char)AdvancedMapTile::Direction::NORTH);
+            }
+            else
+            {
+                out.addExits(x, y, (unsigned char)AdvancedMapTile::Direction::EAST);
+                out.addExits(x+1, y, (unsigned char)AdvancedMapTile::Direction::WEST);
+            }
+        }
+    }
+
+    out.exit = point{rng.below(_w), rng.below(_h)};
+    out.setFlag(MAZE_FLAG_EXIT, out.exit, true);
+
+    out.players = pickStarts(farStartLayer(MazeBits(out), out.exit, players, rng), players, rng);
+
+    cout << "Done!" << endl;
+
+    return out;
+}
+
+template class KruskalGeneratorT<maze<AdvancedMapTile>>;
+template class KruskalGeneratorT<BlockedAdvancedMaze>;
+template class KruskalGeneratorT<GuardedAdvancedMaze>;
+template class KruskalGeneratorT<PackedAdvancedMaze>;
@@ -0,0 +1,47 @@
+#ifndef _KRUSKAL_GEN_H
+#define _KRUSKAL_GEN_H
+
+#include "../../Interfaces/mazegenerator.h"
+#include "../../types.h"
+#include "../../attributeTypes.h"
+#include "../../Interfaces/backend_types.h"
+#include "../../Interfaces/packedplanes.h"
+
+#include <cstdint>
+#include <vector>
+
+//Generates a maze with randomized Kruskal's algorithm
+//Every wall between two tiles is put in a random order, then opened if the
+//tiles on either side aren't connected yet, tracked by a disjoint set
+//forest in one flat array. There is no backtracking stack and memory is a
+//fixed few bytes a tile, and the passages branch far more often than a
+//depth first maze's long corridors. Walls that would have made a loop are
+//opened anyway percentCycles% of the time
+//Tile and wall numbers are 32 bit, so mazes must have fewer than 2^31 tiles
+//Built for maze<AdvancedMapTile>, BlockedAdvancedMaze, GuardedAdvancedMaze,
+//and PackedAdvancedMaze in kruskalgenerator.cpp
+template<class Maze>
+class KruskalGeneratorT final : public MazeGenerator<AdvancedMapTile, Maze>
+{
+    unsigned int _w, _h;
+    double _cycles;
+    unsigned int _threads;
+
+    //Walls in a random order, as tile*2 for the wall east of the tile and
+    //tile*2 + 1 for the wall south of it
+    std::vector<uint32_t> _shuffledWalls(MazeRandom& rng);
+
+public:
+    //threads of 0 uses one for each core
+    KruskalGeneratorT(int width, int height, double percentCycles = 0, unsigned int threads = 0) :
+        _w(width), _h(height), _cycles(percentCycles), _threads(threads){}
+
+    Maze generateMaze(unsigned int players, MazeRandom& rng);
+
+    //Returns whether or not the maze wraps around on the edges
+    bool isWrapped(){return false;}
+};
+
+typedef KruskalGeneratorT<maze<AdvancedMapTile>> KruskalGenerator;
+
+#endif
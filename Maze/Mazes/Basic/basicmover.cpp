@@ -9,7 +9,7 @@ void BasicMover::movePlayer(BasicPlayerData& playerData,
                     maze<MapTile>& m)
 {
     point out = point{playerData.x, playerData.y};
-    unsigned char tile = m.at(out).exits;
+    unsigned char tile = m.exits(out);
 
     std::unordered_map<int, std::unordered_map<int, bool>>& visited = _visited[playerData.id];
     visited[out.x][out.y] = true;
@@ -57,3 +57,19 @@ void BasicMover::movePlayer(BasicPlayerData& playerData,
     playerData.x = out.x;
     playerData.y = out.y;
 }
+
+std::shared_ptr<const MoverState> BasicMover::saveState()
+{
+    std::shared_ptr<State> out = std::make_shared<State>();
+    out->visited = _visited;
+    return out;
+}
+
+void BasicMover::restoreState(const MoverState* state)
+{
+    const State* s = dynamic_cast<const State*>(state);
+    if(s)
+        _visited = s->visited;
+    else
+        _visited.clear();
+}
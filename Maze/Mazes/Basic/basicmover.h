@@ -10,7 +10,13 @@
 
 class BasicMover : public PlayerMover<BasicPlayerData, PlayerMove, MapTile>
 {
-    std::unordered_map<int, std::unordered_map<int, std::unordered_map<int, bool>>> _visited; //Map player to x to y to visited or not
+    typedef std::unordered_map<int, std::unordered_map<int, std::unordered_map<int, bool>>> VisitedMap;
+    VisitedMap _visited; //Map player to x to y to visited or not
+
+    struct State : public MoverState
+    {
+        VisitedMap visited;
+    };
 public:
     virtual PlayerMove defaultMove()
     {
@@ -20,6 +26,9 @@ public:
     void movePlayer(BasicPlayerData& playerData,
                      const PlayerMove& move,
                      maze<MapTile>& m);
+
+    std::shared_ptr<const MoverState> saveState();
+    void restoreState(const MoverState* state);
 };
 
 #endif
\ No newline at end of file
@@ -32,12 +32,12 @@ BasicPlayerData BasicRules::initPlayer(BasicPlayer* player, maze<MapTile>& m)
     return out;
 }
 
-bool BasicRules::playerGetsTurn(BasicPlayerData playerData, const maze<MapTile>& m)
+bool BasicRules::playerGetsTurn(const BasicPlayerData& playerData, const maze<MapTile>& m)
 {
     return playerData.id >= 0;
 }
 
-bool BasicRules::playerIsDone(BasicPlayerData playerData, const maze<MapTile>& m)
+bool BasicRules::playerIsDone(const BasicPlayerData& playerData, const maze<MapTile>& m)
 {
     return playerData.x == m.exit.x && playerData.y == m.exit.y;
 }
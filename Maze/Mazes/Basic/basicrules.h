@@ -19,8 +19,8 @@ public:
     }
     MazeSettings getSettings(const maze<MapTile>& m);
     BasicPlayerData initPlayer(BasicPlayer* player, maze<MapTile>& m);
-    bool playerGetsTurn(BasicPlayerData playerData, const maze<MapTile>& m);
-    bool playerIsDone(BasicPlayerData playerData, const maze<MapTile>& m);
+    bool playerGetsTurn(const BasicPlayerData& playerData, const maze<MapTile>& m);
+    bool playerIsDone(const BasicPlayerData& playerData, const maze<MapTile>& m);
 };
 
 #endif
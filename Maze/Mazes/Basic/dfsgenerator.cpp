@@ -4,30 +4,17 @@
 #include <vector>
 #include <iostream>
 #include <cmath>
-#include <set>
 
 using namespace std;
 
-maze<MapTile> DFSGenerator::generateMaze(unsigned int players)
+maze<MapTile> DFSGenerator::generateMaze(unsigned int players, MazeRandom& rng)
 {
     cerr << "Generating Maze..." << endl;
     
-    _maze = new MapTile[_w*_h];
-    MapTile* iter = _maze;
+    _maze = maze<MapTile>(_w, _h, false);
 
-    //Assign random uids to the maze tiles
-    set<unsigned int> used;
-    for(uint i=0; i<_w*_h; i++)
-    {
-        unsigned int id;
-        do
-        {
-            id = rand();
-        }while(used.insert(id).second == false);
-        iter->uid = id;
-
-        (iter++)->exits = 0;
-    }
+    //Unique uids for the maze tiles, from one number off the stream
+    _maze.deriveUids(TileUids(rng.next()));
 
     //Non-recursive so the stack is on the heap, allowing bigger maze
     stack<point> retrace;
@@ -43,7 +30,7 @@ maze<MapTile> DFSGenerator::generateMaze(unsigned int players)
         }
         else
         {
-            uint choice = rand()%dirs.size();
+            uint choice = rng.below(dirs.size());
             retrace.push(dirs[choice]);
             //cerr << dirs[choice].x << ", " << dirs[choice].y << " <-" << endl;
             _connectTiles(curr, dirs[choice]);
@@ -51,11 +38,12 @@ maze<MapTile> DFSGenerator::generateMaze(unsigned int players)
     }
     cerr << "Done!" << endl;
 
-    maze<MapTile> out(_maze, _w, _h, false);
+    maze<MapTile> out = _maze;
+    _maze = maze<MapTile>();
     for(uint i=0; i<players; i++)
         out.players.push_back(point{0, 0});
-    out.exit = point{rand()%_w, rand()%_h};
-    _maze[_w*out.exit.y + out.exit.x].isExit = true;
+    out.exit = point{rng.below(_w), rng.below(_h)};
+    out.setFlag(MAZE_FLAG_EXIT, out.exit, true);
 
     return out;
 }
@@ -65,45 +53,50 @@ void DFSGenerator::_connectTiles(const point& a, const point& b)
     //cerr << a.x << ", " << a.y << " <-> " << b.x << ", " << b.y << endl;
     if(a.x == b.x-1 && a.y == b.y)
     {
-        _tile(a).exits |= (unsigned char)MapTile::Direction::EAST;
-        _tile(b).exits |= (unsigned char)MapTile::Direction::WEST;
+        _open(a, (unsigned char)MapTile::Direction::EAST);
+        _open(b, (unsigned char)MapTile::Direction::WEST);
     }
     else if(a.x == b.x+1 && a.y == b.y)
     {
-        _tile(a).exits |= (unsigned char)MapTile::Direction::WEST;
-        _tile(b).exits |= (unsigned char)MapTile::Direction::EAST;
+        _open(a, (unsigned char)MapTile::Direction::WEST);
+        _open(b, (unsigned char)MapTile::Direction::EAST);
     }
     else if(a.x == b.x && a.y == b.y-1)
     {
-        _tile(a).exits |= (unsigned char)MapTile::Direction::SOUTH;
-        _tile(b).exits |= (unsigned char)MapTile::Direction::NORTH;
+        _open(a, (unsigned char)MapTile::Direction::SOUTH);
+        _open(b, (unsigned char)MapTile::Direction::NORTH);
     }
     else if(a.x == b.x && a.y == b.y+1)
     {
-        _tile(a).exits |= (unsigned char)MapTile::Direction::NORTH;
-        _tile(b).exits |= (unsigned char)MapTile::Direction::SOUTH;
+        _open(a, (unsigned char)MapTile::Direction::NORTH);
+        _open(b, (unsigned char)MapTile::Direction::SOUTH);
     }
 }
 
 vector<point> DFSGenerator::_getEmptyAdjacent(const point& loc)
 {
     vector<point> out;
-    if(loc.x > 0 && _tile(point{loc.x - 1, loc.y}).exits == (unsigned char)MapTile::Direction::NONE)
+    if(loc.x > 0 && _exits(point{loc.x - 1, loc.y}) == (unsigned char)MapTile::Direction::NONE)
         out.push_back(point{loc.x - 1, loc.y});
 
-    if(loc.x + 1 < _w && _tile(point{loc.x + 1, loc.y}).exits == (unsigned char)MapTile::Direction::NONE)
+    if(loc.x + 1 < _w && _exits(point{loc.x + 1, loc.y}) == (unsigned char)MapTile::Direction::NONE)
         out.push_back(point{loc.x + 1, loc.y});
 
-    if(loc.y > 0 && _tile(point{loc.x, loc.y - 1}).exits == (unsigned char)MapTile::Direction::NONE)
+    if(loc.y > 0 && _exits(point{loc.x, loc.y - 1}) == (unsigned char)MapTile::Direction::NONE)
         out.push_back(point{loc.x, loc.y - 1});
 
-    if(loc.y + 1 < _h && _tile(point{loc.x, loc.y + 1}).exits == (unsigned char)MapTile::Direction::NONE)
+    if(loc.y + 1 < _h && _exits(point{loc.x, loc.y + 1}) == (unsigned char)MapTile::Direction::NONE)
         out.push_back(point{loc.x, loc.y + 1});
 
     return out;
 }
 
-MapTile& DFSGenerator::_tile(const point &loc)
+unsigned char DFSGenerator::_exits(const point &loc) const
+{
+    return _maze.exits(loc);
+}
+
+void DFSGenerator::_open(const point& loc, unsigned char exits)
 {
-    return _maze[loc.y*_w + loc.x];
+    _maze.addExits(loc.x, loc.y, exits);
 }
@@ -4,19 +4,21 @@
 #include "../../Interfaces/mazegenerator.h"
 #include "../../types.h"
 #include "../../Interfaces/backend_types.h"
+#include "../../Interfaces/tileuids.h"
 
 class DFSGenerator : public MazeGenerator<MapTile>
 {
-    MapTile* _maze;
+    maze<MapTile> _maze;
     unsigned int _w, _h;
 
     void _connectTiles(const point& a, const point& b);
-    MapTile& _tile(const point &loc);
+    unsigned char _exits(const point &loc) const;
+    void _open(const point& loc, unsigned char exits);
     std::vector<point> _getEmptyAdjacent(const point& loc);
 public:
     DFSGenerator(int width, int height) : _w(width), _h(height){}
 
-    maze<MapTile> generateMaze(unsigned int players);
+    maze<MapTile> generateMaze(unsigned int players, MazeRandom& rng);
 
     //Returns whether or not the maze wraps around on the edges
     bool isWrapped(){return false;}
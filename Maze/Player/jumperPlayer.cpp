@@ -79,7 +79,7 @@ void JumperPlayer::bfsDead(const MazePoint& start)
         nextToUnknown(start) || isExit(start)) return;
 
     //cerr << "BFS from " << start.x << ", " << start.y << endl;
-    static vector<MazePoint> dirs;
+    static thread_local vector<MazePoint> dirs;
     getValidDirections(start, dirs);
 
     if(dirs.size() == 1)
@@ -121,7 +121,7 @@ PlayerMove JumperPlayer::move(const MapTile* surroundings,                //Cons
             bfsDead(MazePoint{i_, j_});
         }
 
-    static vector<MazePoint> moves;
+    static thread_local vector<MazePoint> moves;
     getValidMoves(currLocation, moves);
 
     //No moves means dead end; move back to last intersection
@@ -221,7 +221,7 @@ void AdvJumperPlayer::bfsDead(const MazePoint& start)
         nextToUnknown(start) || isExit(start)) return;
 
     //cerr << "BFS from " << start.x << ", " << start.y << endl;
-    static vector<MazePoint> dirs;
+    static thread_local vector<MazePoint> dirs;
     getValidDirections(start, dirs);
 
     if(dirs.size() == 1)
@@ -237,7 +237,7 @@ AdvancedPlayerMove AdvJumperPlayer::move(const AdvancedMapTile* surroundings,
                             const uint& loc_x, const uint& loc_y)
 {
     AdvancedPlayerMove out;
-    static vector<MazePoint> moves;
+    static thread_local vector<MazePoint> moves;
 
     const AdvancedMapTile& current = surroundings[loc_y*area_width + loc_x];
     if(current.uid != prevUid)
@@ -283,7 +283,7 @@ AdvancedPlayerMove AdvJumperPlayer::move(const AdvancedMapTile* surroundings,
         }
 
         if(moves.size())
-            to = to + moves[rand()%moves.size()];
+            to = to + moves[_rng.below(moves.size())];
 
         teleported = true;
         out.attemptedMove = AdvancedPlayerMove::Move::MOVETO;
@@ -301,7 +301,7 @@ AdvancedPlayerMove AdvJumperPlayer::move(const AdvancedMapTile* surroundings,
         backtrace.push(currLocation);
     
     out.attemptedMove = AdvancedPlayerMove::Move::MOVETO;
-    out.destination = moves[rand()%moves.size()];
+    out.destination = moves[_rng.below(moves.size())];
 
     teleported = false;
     nextLocation = currLocation + out.destination;
@@ -22,6 +22,7 @@ class JumperPlayer : public BasicPlayer
     MazePoint nextLocation, currLocation;
     unsigned int prevUid = 0;
     bool teleported = false;
+    MazeRandom _rng;
 
 public:
     JumperPlayer(){}
@@ -46,17 +47,20 @@ public:
             backtrace.pop();
     }
 
+    //Color is picked from the game's stream so it stays the same for the whole game
+    virtual void setRandom(const MazeRandom& rng)
+    {
+        _rng = rng;
+        _color[0] = _rng.below(255);
+        _color[1] = _rng.below(255);
+        _color[2] = _rng.below(255);
+    }
+
     //Return a string to be the player's name
     virtual std::string playerName(){return "Jumper";}
 
     //Return an unsigned char[3] RGB color array
-    virtual unsigned char* playerColor()
-    {
-        _color[0] = rand()%255;
-        _color[1] = rand()%255;
-        _color[2] = rand()%255;
-        return _color;
-    }
+    virtual unsigned char* playerColor(){return _color;}
 
     //Main player interface. The game will call getMove and the player will
     //return a direction to move. If it is an invalid direction, they forfeit their
@@ -69,7 +73,7 @@ public:
 
 class AdvJumperPlayer : public AttributePlayer
 {
-    unsigned char _color[3] = {rand()%255, rand()%255, rand()%255};
+    unsigned char _color[3] = {0, 0, 0};
 
     std::stack<MazePoint> backtrace;
     std::unordered_map<int, std::unordered_map<int, AdvancedMapTile>> explored;
@@ -78,6 +82,7 @@ class AdvJumperPlayer : public AttributePlayer
     MazePoint nextLocation, currLocation;
     unsigned int prevUid = 0;
     bool teleported = false;
+    MazeRandom _rng;
 
 public:
     AdvJumperPlayer(){}
@@ -107,6 +112,15 @@ public:
             backtrace.pop();
     }
 
+    //Color is picked from the game's stream so it stays the same for the whole game
+    virtual void setRandom(const MazeRandom& rng)
+    {
+        _rng = rng;
+        _color[0] = _rng.below(255);
+        _color[1] = _rng.below(255);
+        _color[2] = _rng.below(255);
+    }
+
     //Return a string to be the player's name
     virtual std::string playerName(){return "Jumper";}
 
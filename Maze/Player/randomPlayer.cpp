@@ -9,7 +9,6 @@ using namespace std;
 
 RandomPlayer::RandomPlayer()
 {
-    srand(time(NULL));
 }
 
 RandomPlayer::~RandomPlayer()
@@ -23,7 +22,7 @@ PlayerMove RandomPlayer::move(const MapTile* surroundings,             //Const p
                                 const uint& area_width, const uint& area_height, //Size of local area
                                 const uint& loc_x, const uint& loc_y)            //Location in local grid
 {
-    static vector<unsigned char> moves;
+    static thread_local vector<unsigned char> moves;
     moves.clear();
 
     unsigned char valid = surroundings[loc_y*area_width + loc_x].exits;
@@ -32,14 +31,13 @@ PlayerMove RandomPlayer::move(const MapTile* surroundings,             //Const p
     for(int i=0; i<4; i++, dir <<= 1)
         if((valid & dir) != 0) moves.push_back(dir);
 
-    return PlayerMove((MapTile::Direction)(moves[rand()%moves.size()]));
+    return PlayerMove((MapTile::Direction)(moves[_rng.below(moves.size())]));
 }
 
 
 
 AdvRandomPlayer::AdvRandomPlayer()
 {
-    srand(time(NULL));
 }
 
 AdvRandomPlayer::~AdvRandomPlayer()
@@ -55,7 +53,7 @@ AdvancedPlayerMove AdvRandomPlayer::move(const AdvancedMapTile* surroundings,
 {
     unsigned char valid = surroundings[loc_y*area_width + loc_x].exits;
 
-    static vector<unsigned char> moves;
+    static thread_local vector<unsigned char> moves;
     moves.clear();
 
     unsigned char dir = 1;
@@ -64,7 +62,7 @@ AdvancedPlayerMove AdvRandomPlayer::move(const AdvancedMapTile* surroundings,
 
     if(moves.size())
     {
-        return AdvancedPlayerMove((AdvancedMapTile::Direction)(moves[rand()%moves.size()]));
+        return AdvancedPlayerMove((AdvancedMapTile::Direction)(moves[_rng.below(moves.size())]));
     }
     else
     {
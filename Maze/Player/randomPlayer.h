@@ -11,6 +11,7 @@
 class RandomPlayer : public BasicPlayer
 {
     unsigned char _color[3] = {0, 255, 0};
+    MazeRandom _rng;
 public:
     RandomPlayer();
     virtual ~RandomPlayer();
@@ -18,6 +19,8 @@ public:
     //Sets up the player to run a specific maze type
     virtual void setMazeSettings(const MazeSettings& settings){}
 
+    virtual void setRandom(const MazeRandom& rng){_rng = rng;}
+
     //Return a string to be the player's name
     virtual std::string playerName(){return "Random";}
 
@@ -37,6 +40,7 @@ public:
 class AdvRandomPlayer : public AttributePlayer
 {
     unsigned char _color[3] = {0, 0, 255};
+    MazeRandom _rng;
 public:
     AdvRandomPlayer();
     virtual ~AdvRandomPlayer();
@@ -49,6 +53,8 @@ public:
     //Sets up the player to run a specific maze type
     virtual void setMazeSettings(const MazeSettings& settings){}
 
+    virtual void setRandom(const MazeRandom& rng){_rng = rng;}
+
     //Return a string to be the player's name
     virtual std::string playerName(){return "Random Red";}
 
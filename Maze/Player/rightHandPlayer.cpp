@@ -69,7 +69,7 @@ AdvancedPlayerMove AdvRightHandPlayer::move(const AdvancedMapTile* surroundings,
 {
     AdvancedMapTile loc = surroundings[area_width*loc_y + loc_x];
 
-    if(_stickies > 0 && (rand() % 100 == 0))
+    if(_stickies > 0 && (_rng.below(100) == 0))
     {
         _stickies--;
         AdvancedPlayerMove out;
@@ -45,6 +45,7 @@ class AdvRightHandPlayer : public AttributePlayer
     unsigned char _currDir = 1;
     unsigned char _color[3] = {255, 255, 0};
     unsigned int _stickies = 4;
+    MazeRandom _rng;
 public:
     AdvRightHandPlayer();
     virtual ~AdvRightHandPlayer();
@@ -60,6 +61,8 @@ public:
     //Sets up the player to run a specific maze type
     virtual void setMazeSettings(const MazeSettings& settings){}
 
+    virtual void setRandom(const MazeRandom& rng){_rng = rng;}
+
     //Return a string to be the player's name
     virtual std::string playerName(){return "Righty Med";}
 
@@ -141,7 +141,7 @@ void Spartacus::setMazeSettings(const MazeSettings& settings)
 //An intersection with > 1 valid (non dead end) exits is hit
 void Spartacus::bfsDeadEnds(const MazePoint& start)
 {
-    static vector<MazePoint> exits;
+    static thread_local vector<MazePoint> exits;
     MazePoint curr = start;
     MazePoint next;
     bool more = true;
@@ -185,7 +185,7 @@ void Spartacus::bfsDeadEnds(const MazePoint& start)
 
 void Spartacus::bfsExit(const MazePoint& start)
 {
-    static vector<MazePoint> exits;
+    static thread_local vector<MazePoint> exits;
     if(exitDists[start.x][start.y] == 0) return;
     queue<MazePoint> bfs;
     bfs.push(start);
@@ -409,7 +409,7 @@ AdvancedPlayerMove Spartacus::move(const AdvancedMapTile* surroundings,
         return out;
     }
 
-    static vector<MazePoint> moves;
+    static thread_local vector<MazePoint> moves;
     getValidDirections(location, moves);
 
     vector<MazePoint> goodMoves;
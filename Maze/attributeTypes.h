@@ -17,6 +17,8 @@ struct AdvancedMapTile
         WEST = 8
     };
 
+    //Ids of the players standing on the tile, only filled in for maze sections
+    //The maze keeps track of players in its OccupancyIndex
     std::vector<unsigned int> players;
     unsigned int uid;
     bool isExit = false;
@@ -33,7 +35,7 @@ struct AdvancedMapTile
         return !(*this == o);
     }
 
-    bool getColor(unsigned char* c)
+    bool getColor(unsigned char* c) const
     {
         if(isExit)
         {
@@ -0,0 +1,65 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "Mazes/Basic/dfsgenerator.h"
+#include "Mazes/Advanced/advancedgenerator.h"
+#include "Mazes/Advanced/blockgenerator.h"
+#include "Mazes/Advanced/ellergenerator.h"
+#include "Mazes/Advanced/kruskalgenerator.h"
+
+using namespace std;
+
+//Compares how quickly each generator builds mazes of a few sizes, counting
+//everything generateMaze does, start placement included
+//Usage: genbench [threads] [size...]
+
+typedef chrono::steady_clock benchClock;
+
+template<class Tile>
+static void benchGenerator(ostream& results, const char* name, MazeGenerator<Tile>& gen, unsigned int size)
+{
+    MazeRandom rng(1, 0);
+    benchClock::time_point start = benchClock::now();
+    maze<Tile> m = gen.generateMaze(4, rng);
+    double elapsed = chrono::duration<double>(benchClock::now() - start).count();
+
+    m.destroy();
+
+    results << "  " << name << ": " << elapsed << " s, "
+            << (double)size*size/elapsed/1e6 << " M tiles/s" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int threads = argc > 1 ? stoul(argv[1]) : 0;
+    vector<unsigned int> sizes;
+    for(int i=2; i<argc; i++)
+        sizes.push_back(stoul(argv[i]));
+    if(sizes.empty())
+        sizes = {250, 500, 1000, 2000};
+
+    //Keep the generators' progress messages out of the results
+    ostream results(cout.rdbuf());
+    cout.rdbuf(nullptr);
+    cerr.rdbuf(nullptr);
+
+    for(unsigned int size : sizes)
+    {
+        results << size << "x" << size << " maze" << endl;
+
+        DFSGenerator dfs(size, size);
+        AdvancedGenerator advanced(size, size);
+        EllerGenerator eller(size, size);
+        BlockGenerator blocks(size, size, 0, threads);
+        KruskalGenerator kruskal(size, size, 0, threads);
+
+        benchGenerator(results, "dfs (basic)", dfs, size);
+        benchGenerator(results, "advanced", advanced, size);
+        benchGenerator(results, "eller", eller, size);
+        benchGenerator(results, "blocks", blocks, size);
+        benchGenerator(results, "kruskal", kruskal, size);
+    }
+    return 0;
+}
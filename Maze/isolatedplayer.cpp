@@ -0,0 +1,387 @@
+#include "isolatedplayer.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <type_traits>
+
+using namespace std;
+
+static_assert(is_trivially_copyable<MazeRandom>::value, "MazeRandom is sent to player processes as raw bytes");
+
+//Tiles are sent as uid, one byte of exits and flags, then the players on them
+static void writeTile(ReplayWriter& out, const AdvancedMapTile& t)
+{
+    out.putVarint(t.uid);
+    out.putByte((t.exits & 0x0F) | (t.isExit ? 0x10 : 0) | (t.hasStickyBomb ? 0x20 : 0));
+    out.putVarint(t.players.size());
+    for(unsigned int p : t.players)
+        out.putVarint(p);
+}
+
+static void readTile(ReplayReader& in, AdvancedMapTile& t)
+{
+    t.uid = in.getVarint();
+    unsigned char flags = in.getByte();
+    t.exits = flags & 0x0F;
+    t.isExit = flags & 0x10;
+    t.hasStickyBomb = flags & 0x20;
+    t.players.resize(in.getVarint());
+    for(unsigned int& p : t.players)
+        p = in.getVarint();
+}
+
+static string defaultHost()
+{
+    char path[PATH_MAX];
+    ssize_t len = readlink("/proc/self/exe", path, sizeof(path)-1);
+    if(len <= 0) return "./playerhost";
+
+    string exe(path, len);
+    return exe.substr(0, exe.rfind('/')+1) + "playerhost";
+}
+
+IsolatedPlayer::IsolatedPlayer(pid_t pid, void* memory, size_t memorySize, uint32_t ringCapacity) :
+    _pid(pid), _memory(memory), _memorySize(memorySize),
+    _requests(memory, ringCapacity, false),
+    _replies((unsigned char*)memory + SharedRing::bytesNeeded(ringCapacity), ringCapacity, false),
+    _dead(false)
+{
+
+}
+
+IsolatedPlayer* IsolatedPlayer::start(const string& library, const IsolationSettings& settings)
+{
+    size_t ringSize = SharedRing::bytesNeeded(RING_CAPACITY);
+    size_t size = ringSize*2;
+
+    int fd = memfd_create("mazeplayer", MFD_CLOEXEC);
+    if(fd < 0 || ftruncate(fd, size) != 0)
+    {
+        cout << "Unable to create shared memory for " << library << endl;
+        if(fd >= 0) close(fd);
+        return nullptr;
+    }
+
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(memory == MAP_FAILED)
+    {
+        cout << "Unable to map shared memory for " << library << endl;
+        close(fd);
+        return nullptr;
+    }
+    SharedRing(memory, RING_CAPACITY, true);
+    SharedRing((unsigned char*)memory + ringSize, RING_CAPACITY, true);
+
+    //Everything the child needs is built before forking, since only
+    //async signal safe calls are allowed between fork and exec when
+    //other threads are running
+    string host = settings.host.size() ? settings.host : defaultHost();
+    string memoryLimit = to_string(settings.memoryLimitMB);
+    const char* argv[] = {host.c_str(), library.c_str(), "3", memoryLimit.c_str(), nullptr};
+
+    pid_t pid = fork();
+    if(pid == 0)
+    {
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        if(fd == 3)
+            fcntl(fd, F_SETFD, 0);
+        else
+            dup2(fd, 3);
+        execv(host.c_str(), (char* const*)argv);
+        _exit(127);
+    }
+    close(fd);
+
+    if(pid < 0)
+    {
+        cout << "Unable to start player process for " << library << endl;
+        munmap(memory, size);
+        return nullptr;
+    }
+
+    IsolatedPlayer* out = new IsolatedPlayer(pid, memory, size, RING_CAPACITY);
+
+    //Name and color never change, so they are asked for once
+    out->_out.clear();
+    if(out->_call(IsolatedCall::NAME, true))
+        out->_name = out->_in.getString();
+
+    out->_out.clear();
+    if(out->_call(IsolatedCall::COLOR, true))
+    {
+        for(unsigned char& c : out->_color)
+            c = out->_in.getByte();
+    }
+
+    if(out->_dead)
+    {
+        cout << "Player process for " << library << " failed to start" << endl;
+        delete out;
+        return nullptr;
+    }
+    return out;
+}
+
+IsolatedPlayer::~IsolatedPlayer()
+{
+    if(!_dead)
+    {
+        _out.clear();
+        _call(IsolatedCall::QUIT, false);
+    }
+
+    //Give the player a moment to clean up before killing it
+    bool exited = false;
+    for(unsigned int i=0; i<100 && !exited; i++)
+    {
+        exited = _reapIfExited();
+        if(!exited) usleep(1000);
+    }
+    if(!exited)
+        _kill();
+
+    munmap(_memory, _memorySize);
+}
+
+bool IsolatedPlayer::_reapIfExited()
+{
+    lock_guard<mutex> lock(_reapLock);
+    int status;
+    if(!_reaped && waitpid(_pid, &status, WNOHANG) != 0)
+        _reaped = true;
+    return _reaped;
+}
+
+void IsolatedPlayer::_kill()
+{
+    lock_guard<mutex> lock(_reapLock);
+    if(_reaped) return;
+
+    int status;
+    kill(_pid, SIGKILL);
+    waitpid(_pid, &status, 0);
+    _reaped = true;
+}
+
+void IsolatedPlayer::abandon()
+{
+    _dead = true;
+    _kill();
+}
+
+bool IsolatedPlayer::_childAlive()
+{
+    if(_dead || _reapIfExited())
+        _dead = true;
+    return !_dead;
+}
+
+bool IsolatedPlayer::_call(IsolatedCall call, bool reply)
+{
+    if(_dead) return false;
+
+    auto alive = [this](){return _childAlive();};
+
+    uint32_t len = _out.data().size();
+    unsigned char header[5];
+    memcpy(header, &len, 4);
+    header[4] = (unsigned char)call;
+
+    bool ok = _requests.write(header, 5, alive) &&
+              _requests.write(_out.data().data(), len, alive);
+
+    if(ok && reply)
+    {
+        ok = _replies.read(&len, 4, alive);
+        if(ok && len > MAX_REPLY)
+        {
+            cout << "Player " << _name << " sent a " << len << " byte reply" << endl;
+            ok = false;
+        }
+        if(ok)
+        {
+            _inBuf.resize(len);
+            ok = _replies.read(_inBuf.data(), len, alive);
+            _in.reset(_inBuf);
+        }
+    }
+
+    if(!ok && call != IsolatedCall::QUIT)
+    {
+        _dead = true;
+        cout << "Player " << _name << " died, it will make no more moves" << endl;
+    }
+    return ok;
+}
+
+PlayerAttributes IsolatedPlayer::getAttributes(unsigned int points)
+{
+    PlayerAttributes out = PlayerAttributes();
+
+    _out.clear();
+    _out.putVarint(points);
+    if(!_call(IsolatedCall::ATTRIBUTES, true))
+        return out;
+
+    out.speed = _in.getVarint();
+    out.intelligence = _in.getVarint();
+    out.strength = _in.getVarint();
+    out.luck = _in.getVarint();
+    out.mysticality = _in.getVarint();
+    out.cunning = _in.getVarint();
+    out.sense = _in.getVarint();
+    out.agility = _in.getVarint();
+    return out;
+}
+
+void IsolatedPlayer::setMazeSettings(const MazeSettings& settings)
+{
+    _out.clear();
+    _out.putVarint(settings.map_width);
+    _out.putVarint(settings.map_height);
+    _out.putByte(settings.map_wraps);
+    _out.putSigned(settings.exit_x);
+    _out.putSigned(settings.exit_y);
+    _call(IsolatedCall::SETTINGS, false);
+}
+
+void IsolatedPlayer::setRandom(const MazeRandom& rng)
+{
+    _out.clear();
+    const unsigned char* bytes = (const unsigned char*)&rng;
+    for(unsigned int i=0; i<sizeof(MazeRandom); i++)
+        _out.putByte(bytes[i]);
+    _call(IsolatedCall::RANDOM, false);
+}
+
+AdvancedPlayerMove IsolatedPlayer::move(const AdvancedMapTile* surroundings,
+                                        const uint& area_width, const uint& area_height,
+                                        const uint& loc_x, const uint& loc_y)
+{
+    AdvancedPlayerMove out;
+
+    _out.clear();
+    _out.putVarint(area_width);
+    _out.putVarint(area_height);
+    _out.putVarint(loc_x);
+    _out.putVarint(loc_y);
+    for(unsigned int i=0; i<area_width*area_height; i++)
+        writeTile(_out, surroundings[i]);
+
+    _moveCpuSeconds = -1;
+    if(_call(IsolatedCall::MOVE, true))
+    {
+        replayRead(_in, _in.getByte(), out);
+        _moveCpuSeconds = _in.getVarint()*1e-9;
+    }
+    return out;
+}
+
+int serveIsolatedPlayer(AttributePlayer* player, SharedRing& requests, SharedRing& replies, pid_t parent)
+{
+    auto alive = [parent](){return getppid() == parent;};
+
+    ReplayWriter out;
+    ReplayReader in;
+    vector<unsigned char> inBuf;
+    vector<AdvancedMapTile> section;
+
+    while(true)
+    {
+        uint32_t len;
+        unsigned char header[5];
+        if(!requests.read(header, 5, alive)) return 1;
+        memcpy(&len, header, 4);
+
+        inBuf.resize(len);
+        if(!requests.read(inBuf.data(), len, alive)) return 1;
+        in.reset(inBuf);
+
+        out.clear();
+        switch((IsolatedCall)header[4])
+        {
+            case IsolatedCall::NAME:
+                out.putString(player->playerName());
+            break;
+            case IsolatedCall::COLOR:
+            {
+                unsigned char* c = player->playerColor();
+                for(unsigned int i=0; i<3; i++)
+                    out.putByte(c ? c[i] : 0);
+            }
+            break;
+            case IsolatedCall::ATTRIBUTES:
+            {
+                PlayerAttributes a = player->getAttributes(in.getVarint());
+                out.putVarint(a.speed);
+                out.putVarint(a.intelligence);
+                out.putVarint(a.strength);
+                out.putVarint(a.luck);
+                out.putVarint(a.mysticality);
+                out.putVarint(a.cunning);
+                out.putVarint(a.sense);
+                out.putVarint(a.agility);
+            }
+            break;
+            case IsolatedCall::SETTINGS:
+            {
+                MazeSettings s;
+                s.map_width = in.getVarint();
+                s.map_height = in.getVarint();
+                s.map_wraps = in.getByte();
+                s.exit_x = in.getSigned();
+                s.exit_y = in.getSigned();
+                player->setMazeSettings(s);
+            }
+            continue;
+            case IsolatedCall::RANDOM:
+            {
+                MazeRandom rng;
+                unsigned char* bytes = (unsigned char*)&rng;
+                for(unsigned int i=0; i<sizeof(MazeRandom); i++)
+                    bytes[i] = in.getByte();
+                player->setRandom(rng);
+            }
+            continue;
+            case IsolatedCall::MOVE:
+            {
+                uint w = in.getVarint();
+                uint h = in.getVarint();
+                uint x = in.getVarint();
+                uint y = in.getVarint();
+                section.resize(w*h);
+                for(AdvancedMapTile& t : section)
+                    readTile(in, t);
+
+                //The move is followed by the CPU time it took in nanoseconds
+                timespec start, end;
+                clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+                AdvancedPlayerMove move = player->move(section.data(), w, h, x, y);
+                clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end);
+                replayWrite(out, move);
+                out.putVarint((end.tv_sec - start.tv_sec)*1000000000ull + end.tv_nsec - start.tv_nsec);
+            }
+            break;
+            case IsolatedCall::QUIT:
+            default:
+                return 0;
+        }
+
+        len = out.data().size();
+        if(!replies.write(&len, 4, alive) || !replies.write(out.data().data(), len, alive))
+            return 1;
+    }
+}
+
+template<>
+AttributePlayer* createIsolatedPlayer<AttributePlayer>(const string& library, const IsolationSettings& settings)
+{
+    return IsolatedPlayer::start(library, settings);
+}
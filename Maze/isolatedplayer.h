@@ -0,0 +1,129 @@
+#ifndef _ISOLATED_PLAYER_H
+#define _ISOLATED_PLAYER_H
+
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+#include "./Interfaces/attributePlayer.h"
+#include "replay.h"
+#include "sharedring.h"
+
+//How player processes are started
+struct IsolationSettings
+{
+    //playerhost binary, taken from next to the running program when empty
+    std::string host;
+
+    //Address space limit for each player process in MB, 0 for none
+    unsigned int memoryLimitMB = 0;
+};
+
+//Calls a player process understands
+enum class IsolatedCall : unsigned char
+{
+    NAME,
+    COLOR,
+    ATTRIBUTES,
+    SETTINGS,
+    RANDOM,
+    MOVE,
+    QUIT
+};
+
+//Stand in for a player running in a playerhost process of its own
+//Every call is written to a shared memory ring and answered on another,
+//so a player that crashes or runs out of memory only takes its own
+//process down, and can't touch the game's memory. A dead player keeps
+//its name and color and makes NOOP moves for the rest of the game
+class IsolatedPlayer : public AttributePlayer
+{
+    pid_t _pid;
+    void* _memory;
+    size_t _memorySize;
+    SharedRing _requests;
+    SharedRing _replies;
+    std::atomic<bool> _dead;
+
+    //Whether the process has been waited for, after which its pid may
+    //belong to another process and must not be signalled
+    std::mutex _reapLock;
+    bool _reaped = false;
+
+    std::string _name;
+    unsigned char _color[3] = {0, 0, 0};
+
+    //CPU time the process says the last move took, -1 if it didn't answer
+    double _moveCpuSeconds = -1;
+
+    ReplayWriter _out;
+    ReplayReader _in;
+    std::vector<unsigned char> _inBuf;
+
+    IsolatedPlayer(pid_t pid, void* memory, size_t memorySize, uint32_t ringCapacity);
+
+    bool _childAlive();
+
+    //Reaps the process if it has exited, returns whether it is gone
+    bool _reapIfExited();
+
+    //Kills the process and waits for it, unless it is already gone
+    void _kill();
+
+    //Sends _out as a call, and reads the answer into _in if there is one
+    bool _call(IsolatedCall call, bool reply);
+
+public:
+    static const uint32_t RING_CAPACITY = 1 << 18;
+
+    //Longest reply a player process may send, far more than any real one
+    //needs. A process claiming more is treated as dead
+    static const uint32_t MAX_REPLY = RING_CAPACITY;
+
+    //Starts a process running the player in library
+    //Returns nullptr if the process could not be started or the player failed to load
+    static IsolatedPlayer* start(const std::string& library, const IsolationSettings& settings);
+
+    ~IsolatedPlayer();
+
+    bool alive() const {return !_dead;}
+
+    std::string playerName() {return _name;}
+    unsigned char* playerColor() {return _color;}
+
+    PlayerAttributes getAttributes(unsigned int points);
+    void setMazeSettings(const MazeSettings& settings);
+    void setRandom(const MazeRandom& rng);
+
+    AdvancedPlayerMove move(const AdvancedMapTile* surroundings,
+                            const uint& area_width, const uint& area_height,
+                            const uint& loc_x, const uint& loc_y);
+
+    //Only the player's own move is charged, timed on the thread it ran on in
+    //its process, not the time spent passing sections back and forth
+    double lastMoveCpuSeconds() {return _moveCpuSeconds;}
+
+    //Kills the process, which ends the move still waiting on it
+    void abandon();
+};
+
+//Player side of the connection. Answers calls on requests until told to quit
+//Returns the host's exit code
+int serveIsolatedPlayer(AttributePlayer* player, SharedRing& requests, SharedRing& replies, pid_t parent);
+
+//Used by PlayerLoader to start isolated players of a given type
+//Only AttributePlayer has a proxy
+template<class PlayerType>
+PlayerType* createIsolatedPlayer(const std::string& library, const IsolationSettings& settings)
+{
+    std::cout << "Players of this type can't be isolated" << std::endl;
+    return nullptr;
+}
+
+template<>
+AttributePlayer* createIsolatedPlayer<AttributePlayer>(const std::string& library, const IsolationSettings& settings);
+
+#endif
@@ -1,29 +1,201 @@
+#include <algorithm>
+#include <climits>
+#include <cstdint>
 #include <iostream>
+#include <string>
+#include <unistd.h>
 
 #include "playerloader.h"
+#include "mazefile.h"
 #include "Mazes/Advanced/advancedgenerator.h"
+#include "Mazes/Advanced/ellergenerator.h"
+#include "Mazes/Advanced/blockgenerator.h"
+#include "Mazes/Advanced/kruskalgenerator.h"
+#include "Mazes/Advanced/chunkedgenerator.h"
 #include "Mazes/Advanced/advancedmover.h"
 #include "Mazes/Advanced/advancedpartitioner.h"
 #include "Mazes/Advanced/advancedrules.h"
 #include "mazerunner.h"
+#include "Interfaces/packedplanes.h"
+#include "Interfaces/chunkedplanes.h"
 
 using namespace std;
 
-int main(int argc, char *argv[])
+typedef ReplayRecorder<AdvancedPlayerData, AdvancedPlayerMove> AdvancedRecorder;
+typedef ReplayPlayback<AdvancedPlayerData, AdvancedPlayerMove> AdvancedPlayback;
+
+static void usage(const char* name)
+{
+    cerr << "Usage: " << name << " [options]" << endl
+         << "  -j N     Worker threads for player moves (default 0, serial)" << endl
+         << "           and for -B and -K generation (default 0, one per core)" << endl
+         << "  -s SEED  Random seed (default from the clock)" << endl
+         << "  -e       Skip ticks where every player is waiting" << endl
+         << "  -W N     Maze width and height (default 400), powers of two wrap fastest" << endl
+         << "  -w       Wrap the maze round its edges" << endl
+         << "  -E       Generate the maze a row at a time with Eller's algorithm" << endl
+         << "  -B       Generate the maze in blocks on worker threads" << endl
+         << "  -K       Generate the maze with randomized Kruskal's algorithm" << endl
+         << "  -L TYPE  How the maze's tiles are laid out in memory: row (default)," << endl
+         << "           blocked, in 16x16 blocks of Z-ordered tiles, or guarded, inside" << endl
+         << "           a ring of walls so sections need no bounds checks" << endl
+         << "  -P       Keep the maze packed, half a byte a tile, for mazes too big" << endl
+         << "           for a byte a tile" << endl
+         << "  -C N     Make the maze a chunk at a time as it is looked at, keeping" << endl
+         << "           at most N chunks of 256x256 tiles (0 for all, a few a player" << endl
+         << "           at least), for mazes too big to hold" << endl
+         << "           Ignores -w, -P, -E, -B, -K and -m" << endl
+         << "  -t MS    Time a player may take for one move" << endl
+         << "  -T MS    CPU time a player may spend on moves over the game" << endl
+         << "  -i       Run each player in a process of its own" << endl
+         << "  -M MB    Memory limit for each isolated player" << endl
+         << "  -m FILE  Load the maze from FILE if it was made with the same seed," << endl
+         << "           otherwise generate it and save it there" << endl
+         << "  -r FILE  Record the game to FILE" << endl
+         << "  -R FILE  Replay the game recorded in FILE instead of loading players" << endl;
+}
+
+//Options main reads, handed on to play
+struct GameOptions
+{
+    unsigned int threads = 0, seed = 0, size = 400;
+    bool scheduled = false, wrapped = false, eller = false, blocks = false, kruskal = false;
+    bool chunked = false;
+    size_t chunks = 0;
+    MoveBudget budget;
+    bool isolated = false;
+    IsolationSettings isolation;
+    string recordPath, replayPath, mazePath;
+};
+
+//Plays a game on mazes from gen, Maze picks how the maze is stored
+template<class Maze>
+static int play(const GameOptions& o, MazeGenerator<AdvancedMapTile, Maze>* gen)
 {
-    AdvancedGenerator mazeGen(400, 400);
-    AdvancedMover playerMove;
-    AdvancedPartitioner part;
-    AdvancedRules rules;
-    MazeRunner<AttributePlayer, AdvancedPlayerData, AdvancedPlayerMove, AdvancedMapTile>
-    m(&mazeGen, &part, &playerMove, &rules, 400*400*20);
+    AdvancedMoverT<Maze> playerMove;
+    AdvancedPartitionerT<Maze> part;
+    AdvancedRulesT<Maze> rules;
+    //Twenty turns a tile, as many as fit for huge mazes
+    unsigned int maxTurns = min<uint64_t>((uint64_t)o.size*o.size*20, UINT_MAX);
+    MazeRunner<AttributePlayer, AdvancedPlayerData, AdvancedPlayerMove, AdvancedMapTile,
+               VirtualComponents<AttributePlayer, AdvancedPlayerData, AdvancedPlayerMove, AdvancedMapTile, Maze>>
+    m(gen, &part, &playerMove, &rules, maxTurns, o.seed);
     PlayerLoader<AttributePlayer> g(&m);
+    m.setWorkerThreads(o.threads);
+    m.useEventScheduler(o.scheduled);
+    m.setMoveBudget(o.budget);
+
+    AdvancedPlayback playback;
+    if(o.replayPath.size())
+    {
+        if(!playback.load(o.replayPath))
+        {
+            cerr << "Could not read replay " << o.replayPath << endl;
+            return 1;
+        }
+        m.replayFrom(&playback);
+    }
+    else
+    {
+        if(o.isolated)
+            g.isolatePlayers(o.isolation);
+        g.loadPlayers("./Players");
+    }
 
-    g.loadPlayers("./Players");
+    AdvancedRecorder recorder(o.recordPath);
+    if(o.recordPath.size())
+        m.recordTo(&recorder);
 
     m.setup();
 
     while(m.tickGame());
 
+    if(o.recordPath.size() && !recorder.close())
+    {
+        cerr << "Could not write replay " << o.recordPath << endl;
+        return 1;
+    }
+
     return 0;
 }
+
+//Plays a game on a maze generated whole up front, or loaded from a file
+template<class Maze>
+static int playGenerated(const GameOptions& o)
+{
+    AdvancedGeneratorT<Maze> advancedGen(o.size, o.size, 0, o.wrapped);
+    EllerGeneratorT<Maze> ellerGen(o.size, o.size);
+    BlockGeneratorT<Maze> blockGen(o.size, o.size, 0, o.threads);
+    KruskalGeneratorT<Maze> kruskalGen(o.size, o.size, 0, o.threads);
+    MazeGenerator<AdvancedMapTile, Maze>* mazeGen = &advancedGen;
+    if(o.eller) mazeGen = &ellerGen;
+    else if(o.blocks) mazeGen = &blockGen;
+    else if(o.kruskal) mazeGen = &kruskalGen;
+    if((o.eller || o.blocks || o.kruskal) && o.wrapped)
+        cerr << "Only the default generator can wrap, the maze won't" << endl;
+
+    MazeFileGenerator<AdvancedMapTile, Maze> cachedGen(mazeGen, o.mazePath, o.size, o.size);
+    return play<Maze>(o, o.mazePath.size() ? &cachedGen : mazeGen);
+}
+
+//Plays a game on a maze made a chunk at a time as players get to it
+static int playChunked(const GameOptions& o)
+{
+    if(o.wrapped || o.eller || o.blocks || o.kruskal || o.mazePath.size())
+        cerr << "Chunked mazes are made their own way, ignoring -w, -E, -B, -K and -m" << endl;
+
+    ChunkedGenerator gen(o.size, o.size, o.chunks);
+    return play<ChunkedAdvancedMaze>(o, &gen);
+}
+
+int main(int argc, char *argv[])
+{
+    GameOptions o;
+    bool packed = false;
+    string layout = "row";
+
+    int opt;
+    while((opt = getopt(argc, argv, "j:s:eW:wEBKL:PC:t:T:iM:m:r:R:h")) != -1)
+    {
+        switch(opt)
+        {
+            case 'j': o.threads = stoul(optarg); break;
+            case 's': o.seed = stoul(optarg); break;
+            case 'e': o.scheduled = true; break;
+            case 'W': o.size = stoul(optarg); break;
+            case 'w': o.wrapped = true; break;
+            case 'E': o.eller = true; break;
+            case 'B': o.blocks = true; break;
+            case 'K': o.kruskal = true; break;
+            case 'L': layout = optarg; break;
+            case 'P': packed = true; break;
+            case 'C': o.chunked = true; o.chunks = stoull(optarg); break;
+            case 't': o.budget.callSeconds = stod(optarg)/1000; break;
+            case 'T': o.budget.gameSeconds = stod(optarg)/1000; break;
+            case 'i': o.isolated = true; break;
+            case 'M': o.isolation.memoryLimitMB = stoul(optarg); break;
+            case 'm': o.mazePath = optarg; break;
+            case 'r': o.recordPath = optarg; break;
+            case 'R': o.replayPath = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+
+    if(layout != "row" && layout != "blocked" && layout != "guarded")
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    if(layout != "row" && (packed || o.chunked))
+        cerr << "Packed and chunked mazes are laid out their own way, ignoring -L" << endl;
+
+    if(o.chunked)
+        return playChunked(o);
+    if(packed)
+        return playGenerated<PackedAdvancedMaze>(o);
+    if(layout == "blocked")
+        return playGenerated<BlockedAdvancedMaze>(o);
+    if(layout == "guarded")
+        return playGenerated<GuardedAdvancedMaze>(o);
+    return playGenerated<maze<AdvancedMapTile>>(o);
+}
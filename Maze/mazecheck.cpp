@@ -0,0 +1,416 @@
+#include <algorithm>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Interfaces/mazebits.h"
+#include "Interfaces/packedplanes.h"
+#include "Interfaces/chunkedplanes.h"
+#include "Mazes/Advanced/advancedgenerator.h"
+#include "mazesnapshot.h"
+
+using namespace std;
+
+//Checks the bit parallel searches and the flat one generators pick starts
+//with against a plain breadth first search over the tiles, on plain and
+//wrapped mazes of widths either side of a word, that every storage holds
+//the same maze and puts it back from snapshots, and that chunked mazes are
+//whole mazes whatever is kept of them
+//Usage: mazecheck
+//Prints each failure and exits non zero if there were any
+
+static vector<string> failures;
+
+static void fail(const string& what, unsigned int w, unsigned int h, bool wrapped)
+{
+    failures.push_back(what + " on " + to_string(w) + "x" + to_string(h) + (wrapped ? " wrapped" : ""));
+}
+
+//Distance of every tile from x, y, stepping only where both tiles have an
+//exit towards each other, or ~0u where it can't be reached
+template<class Maze>
+static vector<unsigned int> plainDistances(const Maze& m, unsigned int x, unsigned int y)
+{
+    const unsigned int UNSEEN = ~0u;
+    const unsigned int w = m.width(), h = m.height();
+    vector<unsigned int> distance((size_t)w*h, UNSEEN);
+    queue<point> todo;
+    distance[(size_t)w*y + x] = 0;
+    todo.push(point{x, y});
+
+    const int steps[4][4] = {
+        {(int)AdvancedMapTile::Direction::NORTH, (int)AdvancedMapTile::Direction::SOUTH, 0, -1},
+        {(int)AdvancedMapTile::Direction::SOUTH, (int)AdvancedMapTile::Direction::NORTH, 0, 1},
+        {(int)AdvancedMapTile::Direction::EAST, (int)AdvancedMapTile::Direction::WEST, 1, 0},
+        {(int)AdvancedMapTile::Direction::WEST, (int)AdvancedMapTile::Direction::EAST, -1, 0}};
+    while(!todo.empty())
+    {
+        point p = todo.front();
+        todo.pop();
+        unsigned int depth = distance[(size_t)w*p.y + p.x];
+        for(const int* s : steps)
+        {
+            long long nx = (long long)p.x + s[2], ny = (long long)p.y + s[3];
+            if(m.wrapped())
+            {
+                nx = (nx + w) % w;
+                ny = (ny + h) % h;
+            }
+            else if(nx < 0 || ny < 0 || nx >= w || ny >= h)
+                continue;
+
+            if(!(m.exits(p.x, p.y) & s[0]) || !(m.exits(nx, ny) & s[1])) continue;
+            size_t at = (size_t)w*ny + nx;
+            if(distance[at] != UNSEEN) continue;
+            distance[at] = depth + 1;
+            todo.push(point{(unsigned int)nx, (unsigned int)ny});
+        }
+    }
+    return distance;
+}
+
+//Every wall bit against the tiles on both sides of it
+static void checkBits(const MazeBits& bits, const maze<AdvancedMapTile>& m, const string& what)
+{
+    const unsigned int w = m.width(), h = m.height();
+    for(unsigned int y=0; y<h; y++)
+    {
+        for(unsigned int x=0; x<w; x++)
+        {
+            unsigned char here = m.exits(x, y);
+            bool east = (x+1 < w || m.wrapped()) && (here & (unsigned char)AdvancedMapTile::Direction::EAST)
+                && (m.exits((x+1)%w, y) & (unsigned char)AdvancedMapTile::Direction::WEST);
+            bool south = (y+1 < h || m.wrapped()) && (here & (unsigned char)AdvancedMapTile::Direction::SOUTH)
+                && (m.exits(x, (y+1)%h) & (unsigned char)AdvancedMapTile::Direction::NORTH);
+            if(bits.east(x, y) != east || bits.south(x, y) != south)
+            {
+                fail(what + " walls", w, h, m.wrapped());
+                return;
+            }
+        }
+    }
+}
+
+//The flood's layers and what it reached against the plain search from x, y
+static void checkFlood(const MazeBits& bits, const maze<AdvancedMapTile>& m, unsigned int x, unsigned int y, const string& what)
+{
+    const unsigned int w = m.width(), h = m.height();
+    vector<unsigned int> distance = plainDistances(m, x, y);
+
+    MazeFlood flood(bits);
+    flood.start(x, y);
+    do
+    {
+        size_t inLayer = 0;
+        for(unsigned int ty=0; ty<h; ty++)
+        {
+            for(unsigned int tx=0; tx<w; tx++)
+            {
+                bool inFront = distance[(size_t)w*ty + tx] == flood.depth();
+                inLayer += inFront;
+                if(flood.inFront(tx, ty) != inFront)
+                {
+                    fail(what + " flood layer " + to_string(flood.depth()), w, h, m.wrapped());
+                    return;
+                }
+            }
+        }
+        if(flood.frontSize() != inLayer)
+        {
+            fail(what + " flood layer size " + to_string(flood.depth()), w, h, m.wrapped());
+            return;
+        }
+    }while(flood.step());
+
+    for(unsigned int ty=0; ty<h; ty++)
+    {
+        for(unsigned int tx=0; tx<w; tx++)
+        {
+            if(flood.reached(tx, ty) != (distance[(size_t)w*ty + tx] != ~0u))
+            {
+                fail(what + " flood reach", w, h, m.wrapped());
+                return;
+            }
+        }
+    }
+}
+
+//flatLayers from x, y against the plain search, layer by layer
+//It goes through a tile's own exits, so only mazes whose walls match on both
+//sides are checked, as the generators build them
+static void checkFlatLayers(const maze<AdvancedMapTile>& m, unsigned int x, unsigned int y)
+{
+    const unsigned int w = m.width(), h = m.height();
+    vector<unsigned int> distance = plainDistances(m, x, y);
+
+    vector<unsigned int> order;
+    vector<size_t> layerSize;
+    flatLayers(m, point{x, y}, order, layerSize);
+
+    size_t reached = 0;
+    for(unsigned int d : distance) reached += d != ~0u;
+    if(order.size() != reached)
+    {
+        fail("flat layers reach", w, h, m.wrapped());
+        return;
+    }
+
+    size_t i = 0;
+    for(unsigned int d=0; d<layerSize.size(); d++)
+    {
+        for(size_t end = i + layerSize[d]; i<end; i++)
+        {
+            if(distance[order[i]] != d)
+            {
+                fail("flat layer " + to_string(d), w, h, m.wrapped());
+                return;
+            }
+        }
+    }
+}
+
+//Exits, flags and uids of every tile, row by row
+template<class Maze>
+static vector<uint32_t> tiles(const Maze& m)
+{
+    vector<uint32_t> out;
+    for(unsigned int y=0; y<m.height(); y++)
+    {
+        for(unsigned int x=0; x<m.width(); x++)
+        {
+            out.push_back(m.exits(x, y));
+            out.push_back(m.uid(x, y));
+            for(unsigned int f=0; f<MAZE_FLAG_COUNT; f++)
+                out.push_back(m.flag((MazeFlag)f, x, y));
+        }
+    }
+    return out;
+}
+
+//Changes tiles at random, walls and sticky bombs
+template<class Maze>
+static void scribble(Maze& m, MazeRandom& rng)
+{
+    for(unsigned int i=0; i<m.width()*m.height()/8 + 4; i++)
+    {
+        unsigned int x = rng.below(m.width()), y = rng.below(m.height());
+        m.setExits(x, y, rng.below(16));
+        m.setFlag(MAZE_FLAG_STICKY_BOMB, x, y, rng.below(2));
+    }
+}
+
+//Snapshots taken between changes put back the tiles from when they were taken
+template<class Maze>
+static void checkSnapshots(Maze& m, MazeRandom& rng, const string& what)
+{
+    MazeSnapshotter<Maze> snapshotter;
+    MazeSnapshot<Maze> first = snapshotter.capture(m);
+    vector<uint32_t> firstTiles = tiles(m);
+    scribble(m, rng);
+    MazeSnapshot<Maze> second = snapshotter.capture(m);
+    vector<uint32_t> secondTiles = tiles(m);
+    scribble(m, rng);
+
+    snapshotter.restore(first, m);
+    if(tiles(m) != firstTiles) fail(what + " snapshot", m.width(), m.height(), m.wrapped());
+    snapshotter.restore(second, m);
+    if(tiles(m) != secondTiles) fail(what + " later snapshot", m.width(), m.height(), m.wrapped());
+}
+
+//The same stream makes the same maze in another storage, sections of it
+//read the same and it comes back from snapshots
+template<class Maze>
+static void checkStorage(const maze<AdvancedMapTile>& m, MazeRandom from, MazeRandom& rng, const string& what)
+{
+    const unsigned int w = m.width(), h = m.height();
+    AdvancedGeneratorT<Maze> gen(w, h, 30, m.wrapped());
+    Maze other = gen.generateMaze(1, from);
+    if(tiles(m) != tiles(other))
+        fail(what + " tiles", w, h, m.wrapped());
+
+    //Windows hanging off every corner, and round them on wrapped mazes
+    AdvancedMapTile outside;
+    outside.exits = 0;
+    outside.uid = 0;
+    const unsigned int side = 7;
+    vector<AdvancedMapTile> a(side*side), b(side*side);
+    bool same = true;
+    for(long long y : {-3LL, (long long)h/2, (long long)h - 4})
+    {
+        for(long long x : {-3LL, (long long)w/2, (long long)w - 4})
+        {
+            m.readWindow(x, y, side, side, a.data(), outside);
+            other.readWindow(x, y, side, side, b.data(), outside);
+            for(unsigned int i=0; i<side*side; i++)
+                same = same && a[i].exits == b[i].exits && a[i].uid == b[i].uid && a[i].isExit == b[i].isExit;
+        }
+    }
+    if(!same) fail(what + " window", w, h, m.wrapped());
+
+    checkSnapshots(other, rng, what);
+    other.destroy();
+}
+
+static void checkStorages(unsigned int w, unsigned int h, bool wrapped, MazeRandom& rng)
+{
+    MazeRandom from = rng;
+    AdvancedGenerator gen(w, h, 30, wrapped);
+    maze<AdvancedMapTile> m = gen.generateMaze(1, rng);
+
+    checkStorage<BlockedAdvancedMaze>(m, from, rng, "blocked");
+    checkStorage<GuardedAdvancedMaze>(m, from, rng, "guarded");
+    checkStorage<PackedAdvancedMaze>(m, from, rng, "packed");
+    checkSnapshots(m, rng, "planes");
+    m.destroy();
+}
+
+//nearLayers from x, y stopped after limit tiles against the plain search
+//Layers it finishes hold every tile at their distance
+template<class Maze>
+static void checkNearLayers(const Maze& m, unsigned int x, unsigned int y, size_t limit, const string& what)
+{
+    const unsigned int w = m.width(), h = m.height();
+    vector<unsigned int> distance = plainDistances(m, x, y);
+    vector<size_t> plainSize;
+    for(unsigned int d : distance)
+    {
+        if(d == ~0u) continue;
+        if(d >= plainSize.size()) plainSize.resize(d + 1, 0);
+        plainSize[d]++;
+    }
+
+    unordered_map<size_t, unsigned int> found;
+    vector<point> order;
+    vector<size_t> layerSize;
+    nearLayers(m, point{x, y}, limit, nullptr, found, order, layerSize);
+
+    size_t reached = 0;
+    for(size_t n : plainSize) reached += n;
+    if(order.size() < min(limit, reached) || layerSize.size() > plainSize.size())
+    {
+        fail(what + " near layers reach", w, h, m.wrapped());
+        return;
+    }
+
+    size_t i = 0;
+    for(unsigned int d=0; d<layerSize.size(); d++)
+    {
+        if(layerSize[d] != plainSize[d])
+        {
+            fail(what + " near layer size " + to_string(d), w, h, m.wrapped());
+            return;
+        }
+        for(size_t end = i + layerSize[d]; i<end; i++)
+        {
+            if(distance[m.index(order[i].x, order[i].y)] != d)
+            {
+                fail(what + " near layer " + to_string(d), w, h, m.wrapped());
+                return;
+            }
+        }
+    }
+}
+
+//Chunked mazes from one seed are the same whatever is kept, their walls
+//match from both sides and every tile can be reached
+static void checkChunked(unsigned int w, unsigned int h, MazeRandom& rng)
+{
+    typedef maze<AdvancedMapTile, ChunkedPlanes<4>> SmallChunkedMaze;
+    uint64_t seed = rng.next();
+    SmallChunkedMaze m(w, h, false), capped(w, h, false);
+    m.storage().generate(seed, 0);
+    capped.storage().generate(seed, 1);
+    if(tiles(m) != tiles(capped))
+        fail("chunked tiles kept", w, h, false);
+
+    for(unsigned int y=0; y<h; y++)
+    {
+        for(unsigned int x=0; x<w; x++)
+        {
+            unsigned char here = m.exits(x, y);
+            bool east = here & (unsigned char)AdvancedMapTile::Direction::EAST;
+            bool south = here & (unsigned char)AdvancedMapTile::Direction::SOUTH;
+            bool west = x+1 < w && (m.exits(x+1, y) & (unsigned char)AdvancedMapTile::Direction::WEST);
+            bool north = y+1 < h && (m.exits(x, y+1) & (unsigned char)AdvancedMapTile::Direction::NORTH);
+            if(east != west || south != north
+               || (x == 0 && (here & (unsigned char)AdvancedMapTile::Direction::WEST))
+               || (y == 0 && (here & (unsigned char)AdvancedMapTile::Direction::NORTH)))
+            {
+                fail("chunked walls", w, h, false);
+                y = h;
+                break;
+            }
+        }
+    }
+
+    vector<unsigned int> distance = plainDistances(m, 0, 0);
+    if(count(distance.begin(), distance.end(), ~0u))
+        fail("chunked reach", w, h, false);
+
+    checkNearLayers(m, rng.below(w), rng.below(h), ~(size_t)0, "chunked");
+    checkNearLayers(m, rng.below(w), rng.below(h), rng.below(w*h) + 1, "chunked");
+    checkSnapshots(m, rng, "chunked");
+}
+
+static void checkMaze(unsigned int w, unsigned int h, bool wrapped, double cycles, MazeRandom& rng)
+{
+    AdvancedGenerator gen(w, h, cycles, wrapped);
+    maze<AdvancedMapTile> m = gen.generateMaze(1, rng);
+
+    MazeBits bits(m);
+    checkBits(bits, m, "built");
+    for(unsigned int i=0; i<4; i++)
+        checkFlood(bits, m, rng.below(w), rng.below(h), "built");
+    for(unsigned int i=0; i<4; i++)
+        checkFlatLayers(m, rng.below(w), rng.below(h));
+    for(unsigned int i=0; i<4; i++)
+        checkNearLayers(m, rng.below(w), rng.below(h), rng.below(w*h) + 1, "built");
+
+    //Open and close walls at random, from one side only as often as not, and
+    //keep the bits up to date through update
+    for(unsigned int i=0; i<w*h/4 + 8; i++)
+    {
+        unsigned int x = rng.below(w), y = rng.below(h);
+        m.setExits(x, y, rng.below(16));
+        bits.update(m, x, y);
+    }
+    checkBits(bits, m, "updated");
+    for(unsigned int i=0; i<4; i++)
+        checkFlood(bits, m, rng.below(w), rng.below(h), "updated");
+
+    m.destroy();
+}
+
+int main()
+{
+    //Keep the generator's progress messages out of the results
+    ostream results(cout.rdbuf());
+    cout.rdbuf(nullptr);
+    cerr.rdbuf(nullptr);
+
+    MazeRandom rng(1, 0);
+    const unsigned int sizes[][2] = {{1, 1}, {1, 9}, {9, 1}, {3, 3}, {7, 5}, {63, 4}, {64, 6}, {65, 5},
+                                     {127, 3}, {128, 8}, {129, 7}, {200, 40}};
+    for(const unsigned int* size : sizes)
+    {
+        for(bool wrapped : {false, true})
+        {
+            checkMaze(size[0], size[1], wrapped, 0, rng);
+            checkMaze(size[0], size[1], wrapped, 30, rng);
+            checkStorages(size[0], size[1], wrapped, rng);
+        }
+        checkChunked(size[0], size[1], rng);
+    }
+
+    for(const string& f : failures)
+        results << "FAIL " << f << endl;
+    if(failures.size())
+    {
+        results << failures.size() << " checks failed" << endl;
+        return 1;
+    }
+    results << "All checks passed" << endl;
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include "mazefile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+//Whether count items of itemSize bytes from offset lie inside a file of
+//size bytes, without the sums overflowing on hostile offsets
+static bool fitsIn(uint64_t offset, uint64_t count, uint64_t itemSize, uint64_t size)
+{
+    return offset <= size && count <= (size - offset)/itemSize;
+}
+
+bool MazeFile::open(const string& path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return false;
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(MazeFileHeader))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    //The mapping stays valid after the descriptor is closed
+    void* map = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(map == MAP_FAILED) return false;
+
+    size_t size = info.st_size;
+    _map = map;
+    _size = size;
+    _mapping = shared_ptr<void>(map, [size](void* m){munmap(m, size);});
+
+    const MazeFileHeader* h = (const MazeFileHeader*)map;
+    uint64_t tiles = (uint64_t)h->width*h->height;
+    bool ok = memcmp(h->magic, MAZE_FILE_MAGIC, sizeof(h->magic)) == 0 &&
+              h->version == MAZE_FILE_VERSION &&
+              h->startsOffset % sizeof(uint32_t) == 0 &&
+              fitsIn(h->startsOffset, h->starts, 2*sizeof(uint32_t), _size) &&
+              h->exitsOffset % MAZE_FILE_ALIGN == 0 &&
+              fitsIn(h->exitsOffset, tiles, 1, _size) &&
+              h->exitX < h->width && h->exitY < h->height;
+    if(ok && (h->flags & MAZE_FILE_UIDS))
+        ok = h->uidsOffset % sizeof(uint32_t) == 0 && fitsIn(h->uidsOffset, tiles, sizeof(uint32_t), _size);
+
+    //Players must start on the maze
+    if(ok)
+    {
+        const uint32_t* xy = (const uint32_t*)((const unsigned char*)map + h->startsOffset);
+        for(uint32_t i=0; ok && i<h->starts; i++, xy += 2)
+            ok = xy[0] < h->width && xy[1] < h->height;
+    }
+
+    if(!ok)
+    {
+        close();
+        return false;
+    }
+
+    _header = h;
+    return true;
+}
+
+void MazeFile::close()
+{
+    _mapping.reset();
+    _map = nullptr;
+    _size = 0;
+    _header = nullptr;
+}
+
+vector<point> MazeFile::starts() const
+{
+    vector<point> out(_header->starts);
+    const uint32_t* xy = (const uint32_t*)((const unsigned char*)_map + _header->startsOffset);
+    for(point& p : out)
+    {
+        p = point{xy[0], xy[1]};
+        xy += 2;
+    }
+    return out;
+}
+
+MazeFileWriter::~MazeFileWriter()
+{
+    //Never closed, so the file is incomplete
+    if(_file.is_open())
+    {
+        _file.close();
+        remove(_tmp.c_str());
+    }
+}
+
+bool MazeFileWriter::open(const string& path, unsigned int width, unsigned int height, bool wrapped,
+                          bool withUids, unsigned int starts)
+{
+    memset(&_header, 0, sizeof(_header));
+    memcpy(_header.magic, MAZE_FILE_MAGIC, sizeof(_header.magic));
+    _header.version = MAZE_FILE_VERSION;
+    _header.flags = (wrapped ? MAZE_FILE_WRAPPED : 0) | (withUids ? MAZE_FILE_UIDS : 0);
+    _header.width = width;
+    _header.height = height;
+    _header.starts = starts;
+
+    auto align = [](uint64_t offset){return (offset + MAZE_FILE_ALIGN - 1)/MAZE_FILE_ALIGN*MAZE_FILE_ALIGN;};
+    uint64_t tiles = (uint64_t)width*height;
+    _header.startsOffset = sizeof(_header);
+    _header.exitsOffset = align(_header.startsOffset + (uint64_t)starts*2*sizeof(uint32_t));
+    _header.uidsOffset = withUids ? align(_header.exitsOffset + tiles) : 0;
+
+    //Written next to the real file and moved over it, so a reader never maps half a maze
+    _path = path;
+    _tmp = path + ".tmp";
+    _row = 0;
+    _file.open(_tmp, ios::binary | ios::trunc);
+    return _file.is_open();
+}
+
+void MazeFileWriter::writeRow(const unsigned char* exits, const uint32_t* uids)
+{
+    //Rows go straight to where they belong, the gaps before each plane are
+    //left for the file system to fill with zeros
+    uint64_t width = _header.width;
+    _file.seekp(_header.exitsOffset + width*_row);
+    _file.write((const char*)exits, width);
+    if(_header.flags & MAZE_FILE_UIDS)
+    {
+        _file.seekp(_header.uidsOffset + width*_row*sizeof(uint32_t));
+        _file.write((const char*)uids, width*sizeof(uint32_t));
+    }
+    _row++;
+}
+
+bool MazeFileWriter::close(const point& exit, const vector<point>& starts,
+                           const MazeRandom* from, const MazeRandom* to)
+{
+    bool ok = _row == _header.height && starts.size() == _header.starts;
+
+    _header.exitX = exit.x;
+    _header.exitY = exit.y;
+    if(from && to)
+    {
+        _header.flags |= MAZE_FILE_RANDOM;
+        memcpy(_header.randomBefore, (const void*)from, sizeof(MazeRandom));
+        memcpy(_header.randomAfter, (const void*)to, sizeof(MazeRandom));
+    }
+
+    _file.seekp(0);
+    _file.write((const char*)&_header, sizeof(_header));
+    for(const point& p : starts)
+    {
+        uint32_t xy[2] = {(uint32_t)p.x, (uint32_t)p.y};
+        _file.write((const char*)xy, sizeof(xy));
+    }
+
+    //Readers check the file is as long as its planes, even empty ones
+    uint64_t tiles = (uint64_t)_header.width*_header.height;
+    uint64_t need = (_header.flags & MAZE_FILE_UIDS) ? _header.uidsOffset + tiles*sizeof(uint32_t)
+                                                    : _header.exitsOffset + tiles;
+    _file.seekp(0, ios::end);
+    if((uint64_t)_file.tellp() < need)
+    {
+        _file.seekp(need - 1);
+        _file.put(0);
+    }
+
+    _file.close();
+    if(!ok || !_file.good() || rename(_tmp.c_str(), _path.c_str()) != 0)
+    {
+        remove(_tmp.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,277 @@
+#ifndef _MAZE_FILE_H
+#define _MAZE_FILE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "mazerandom.h"
+#include "./Interfaces/backend_types.h"
+#include "./Interfaces/mazegenerator.h"
+
+/*
+ *  Maze files
+ *
+ *  A maze file holds a generated maze so it can be mapped into memory
+ *  instead of generated again. Everything is stored in the machine's own
+ *  byte order:
+ *      MazeFileHeader
+ *      starts      two uint32 per player start
+ *      exits       one byte per tile, row major, at a page boundary
+ *      uids        one uint32 per tile, row major, at a page boundary, optional
+ *
+ *  Planes are used where they sit in the mapping, so opening a file costs
+ *  the same whatever the maze's size, and pages are only read from disk
+ *  when something looks at them. Mazes with row major planes play on the
+ *  mapping itself, see MazeFile::toMaze. Files can also record the random stream
+ *  the maze was generated from, so MazeFileGenerator only reuses a maze
+ *  for the seed it was made with.
+ */
+
+const char MAZE_FILE_MAGIC[4] = {'M', 'Z', 'M', 'F'};
+//2 since tile uids are derived instead of drawn, which changed every seed's maze
+const uint32_t MAZE_FILE_VERSION = 2;
+const uint64_t MAZE_FILE_ALIGN = 4096;
+
+//Planes in a file end on a page boundary, past the chunk their last tile is in,
+//so MazePlanes can save and restore whole chunks of them
+static_assert(MAZE_FILE_ALIGN % MAZE_CHUNK_TILES == 0, "Maze file planes are padded to whole chunks");
+
+enum MazeFileFlags : uint32_t
+{
+    MAZE_FILE_WRAPPED = 1,
+    MAZE_FILE_UIDS = 2,
+    MAZE_FILE_RANDOM = 4
+};
+
+struct MazeFileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t width, height;
+    uint32_t exitX, exitY;
+    uint32_t starts;
+
+    //Random stream before and after generating, when MAZE_FILE_RANDOM is set
+    unsigned char randomBefore[sizeof(MazeRandom)];
+    unsigned char randomAfter[sizeof(MazeRandom)];
+
+    uint64_t startsOffset;
+    uint64_t exitsOffset;
+    uint64_t uidsOffset;
+};
+
+static_assert(std::is_trivially_copyable<MazeFileHeader>::value, "Maze file headers are read straight from the mapping");
+
+//Read only view of a maze file mapped into memory
+//The mapping is private and writable, so mazes made from it can change
+//their copy of a page without touching the file
+class MazeFile
+{
+    void* _map = nullptr;
+    size_t _size = 0;
+    const MazeFileHeader* _header = nullptr;
+
+    //Unmaps the file once neither this nor any maze built on it uses it
+    std::shared_ptr<void> _mapping;
+
+    //Tiles of the file as Storage, copied a tile at a time
+    template<class Storage>
+    void _load(Storage& out) const
+    {
+        out = Storage(width(), height());
+        const unsigned char* e = exits();
+        const uint32_t* u = uids();
+        for(unsigned int y=0; y<height(); y++)
+        {
+            for(unsigned int x=0; x<width(); x++)
+            {
+                size_t i = (size_t)width()*y + x;
+                out.setExits(x, y, e[i]);
+                out.setUid(x, y, u ? u[i] : 0);
+            }
+        }
+    }
+
+    //Row major planes are the file's own, pages are only copied when they
+    //are written to
+    void _load(MazePlanes<RowMajorLayout>& out) const
+    {
+        MazePlane<unsigned char> e;
+        e.data = (unsigned char*)exits();
+        e.owner = _mapping;
+
+        MazePlane<uint32_t> u;
+        if(uids())
+        {
+            u.data = (uint32_t*)uids();
+            u.owner = _mapping;
+        }
+        else
+            u = MazePlane<uint32_t>::allocate((size_t)width()*height());
+
+        out = MazePlanes<RowMajorLayout>(width(), height(), e, u);
+    }
+
+public:
+    MazeFile(){}
+    MazeFile(const MazeFile&) = delete;
+    MazeFile& operator=(const MazeFile&) = delete;
+    ~MazeFile() {close();}
+
+    //Maps the file at path
+    //Returns false if it is missing or not a maze file this build understands
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const {return _header != nullptr;}
+
+    unsigned int width() const {return _header->width;}
+    unsigned int height() const {return _header->height;}
+    bool wrapped() const {return _header->flags & MAZE_FILE_WRAPPED;}
+    point exit() const {return point{_header->exitX, _header->exitY};}
+    std::vector<point> starts() const;
+
+    //Planes in the mapping, row major. uids is nullptr when the file has none
+    const unsigned char* exits() const {return (const unsigned char*)_map + _header->exitsOffset;}
+    const uint32_t* uids() const
+    {
+        if(!(_header->flags & MAZE_FILE_UIDS)) return nullptr;
+        return (const uint32_t*)((const unsigned char*)_map + _header->uidsOffset);
+    }
+
+    unsigned char exits(unsigned int x, unsigned int y) const {return exits()[(size_t)width()*y + x];}
+
+    //Whether the maze was generated from a stream in the same state as rng
+    bool madeFrom(const MazeRandom& rng) const
+    {
+        return (_header->flags & MAZE_FILE_RANDOM) &&
+               memcmp(_header->randomBefore, &rng, sizeof(MazeRandom)) == 0;
+    }
+
+    //Moves rng on to where generating the maze left it
+    void skipGeneration(MazeRandom& rng) const
+    {
+        if(_header->flags & MAZE_FILE_RANDOM)
+            memcpy((void*)&rng, _header->randomAfter, sizeof(MazeRandom));
+    }
+
+    //Builds a maze from the planes. The caller owns the result, which may
+    //keep the file mapped after this is closed
+    template<class Tile, class Maze = maze<Tile>>
+    Maze toMaze() const
+    {
+        typename Maze::StorageType planes;
+        _load(planes);
+        Maze out(planes, width(), height(), wrapped());
+
+        out.exit = exit();
+        out.setFlag(MAZE_FLAG_EXIT, out.exit, true);
+        out.players = starts();
+        return out;
+    }
+};
+
+//Writes a maze file a row at a time, so a maze can be saved while it is
+//generated without ever being held whole
+//The exit and starts are only needed at the end, the number of starts at the start
+class MazeFileWriter
+{
+    std::ofstream _file;
+    std::string _path, _tmp;
+    MazeFileHeader _header;
+    unsigned int _row = 0;
+
+public:
+    MazeFileWriter(){}
+    MazeFileWriter(const MazeFileWriter&) = delete;
+    MazeFileWriter& operator=(const MazeFileWriter&) = delete;
+    ~MazeFileWriter();
+
+    //Starts writing to a file next to path, moved over it by close
+    //Returns false if it could not be created
+    bool open(const std::string& path, unsigned int width, unsigned int height, bool wrapped,
+              bool withUids, unsigned int starts);
+
+    //Writes the next row's exits, and uids if the file has them
+    void writeRow(const unsigned char* exits, const uint32_t* uids);
+
+    //Fills in the exit and starts and moves the file into place. If from and
+    //to are given they are recorded as the random stream before and after
+    //the maze was generated
+    //Returns false if every row wasn't written or the file could not be
+    bool close(const point& exit, const std::vector<point>& starts,
+               const MazeRandom* from = nullptr, const MazeRandom* to = nullptr);
+};
+
+//Writes m to path. from and to are as for MazeFileWriter::close
+//Returns false if the file could not be written
+template<class Maze>
+bool writeMazeFile(const std::string& path, Maze& m, bool withUids = true,
+                   const MazeRandom* from = nullptr, const MazeRandom* to = nullptr)
+{
+    MazeFileWriter out;
+    if(!out.open(path, m.width(), m.height(), m.wrapped(), withUids, m.players.size()))
+        return false;
+
+    std::vector<unsigned char> exitRow(m.width());
+    std::vector<uint32_t> uidRow(m.width());
+    for(unsigned int y=0; y<m.height(); y++)
+    {
+        for(unsigned int x=0; x<m.width(); x++)
+        {
+            exitRow[x] = m.exits(x, y);
+            uidRow[x] = m.uid(x, y);
+        }
+        out.writeRow(exitRow.data(), uidRow.data());
+    }
+
+    return out.close(m.exit, m.players, from, to);
+}
+
+//Generates mazes through another generator, keeping the last one in a file
+//A maze is loaded from the file instead of generated when the file was made
+//from the same random stream with the same number of players, and is the
+//size and wrapping gen makes. Use one file per generator setup, since the
+//file doesn't know the generator's other settings
+template<class Tile, class Maze = maze<Tile>>
+class MazeFileGenerator : public MazeGenerator<Tile, Maze>
+{
+    MazeGenerator<Tile, Maze>* _gen;
+    std::string _path;
+    unsigned int _w, _h;
+
+public:
+    //width and height are the size of the mazes gen makes
+    MazeFileGenerator(MazeGenerator<Tile, Maze>* gen, const std::string& path, unsigned int width, unsigned int height) :
+        _gen(gen), _path(path), _w(width), _h(height){}
+
+    Maze generateMaze(unsigned int players, MazeRandom& rng)
+    {
+        MazeFile file;
+        if(file.open(_path) && file.madeFrom(rng) && file.starts().size() == players &&
+           file.width() == _w && file.height() == _h && file.wrapped() == _gen->isWrapped())
+        {
+            std::cout << "Loading maze from " << _path << std::endl;
+            file.skipGeneration(rng);
+            return file.toMaze<Tile, Maze>();
+        }
+        file.close();
+
+        MazeRandom before = rng;
+        Maze out = _gen->generateMaze(players, rng);
+        if(!writeMazeFile(_path, out, true, &before, &rng))
+            std::cout << "Could not save the maze to " << _path << std::endl;
+        return out;
+    }
+
+    bool isWrapped() {return _gen->isWrapped();}
+};
+
+#endif
@@ -0,0 +1,45 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <sys/resource.h>
+
+#include "Mazes/Advanced/ellergenerator.h"
+
+using namespace std;
+
+//Writes a maze file with Eller's algorithm a row at a time, so the maze is
+//never held in memory and mazes far too big for it can still be made
+//Starts are random tiles away from the exit, see EllerGenerator::generateFile
+
+int main(int argc, char *argv[])
+{
+    if(argc < 4)
+    {
+        cerr << "Usage: " << argv[0] << " WIDTH HEIGHT FILE [SEED] [PLAYERS] [CYCLES]" << endl
+             << "  CYCLES is the percentage of extra walls opened to make loops" << endl;
+        return 1;
+    }
+
+    unsigned int width = stoul(argv[1]), height = stoul(argv[2]);
+    string path = argv[3];
+    unsigned int seed = argc > 4 ? stoul(argv[4]) : 1;
+    unsigned int players = argc > 5 ? stoul(argv[5]) : 4;
+    double cycles = argc > 6 ? stod(argv[6]) : 0;
+
+    EllerGenerator gen(width, height, cycles);
+    MazeRandom rng(seed, 0);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    if(!gen.generateFile(path, players, rng))
+    {
+        cerr << "Could not write " << path << endl;
+        return 1;
+    }
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    cout << "Wrote " << width << "x" << height << " maze to " << path << " in " << elapsed << "s, "
+         << usage.ru_maxrss/1024 << "MB peak memory" << endl;
+    return 0;
+}
@@ -0,0 +1,57 @@
+#ifndef _MAZE_RANDOM_H
+#define _MAZE_RANDOM_H
+
+#include <cstdint>
+
+//PCG32 random number generator (pcg-random.org)
+//Each game owns its own generators instead of sharing the global rand(),
+//and every stream number gives an independent sequence for the same seed,
+//so the maze and each player can draw numbers without disturbing each other
+class MazeRandom
+{
+    uint64_t _state = 0;
+    uint64_t _inc = 1;
+
+public:
+    MazeRandom(uint64_t seed = 0, uint64_t stream = 0)
+    {
+        this->seed(seed, stream);
+    }
+
+    void seed(uint64_t seed, uint64_t stream)
+    {
+        _state = 0;
+        _inc = (stream << 1u) | 1u;
+        next();
+        _state += seed;
+        next();
+    }
+
+    uint32_t next()
+    {
+        uint64_t old = _state;
+        _state = old * 6364136223846793005ULL + _inc;
+        uint32_t xorshifted = ((old >> 18u) ^ old) >> 27u;
+        uint32_t rot = old >> 59u;
+        return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+    }
+
+    uint32_t operator()() {return next();}
+
+    //Uniformly distributed value in [0, bound), or 0 if bound is 0
+    uint32_t below(uint32_t bound)
+    {
+        if(bound == 0) return 0;
+
+        //Reject the few values which would bias the modulo
+        uint32_t threshold = (0u - bound) % bound;
+        while(true)
+        {
+            uint32_t r = next();
+            if(r >= threshold)
+                return r % bound;
+        }
+    }
+};
+
+#endif
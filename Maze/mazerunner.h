@@ -1,9 +1,14 @@
 #ifndef MAZE_H
 #define MAZE_H
 
-#include <unordered_map>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <ctime>
+#include <memory>
+#include <functional>
+#include <queue>
+#include <utility>
 #include <vector>
 
 #include "./Interfaces/player.h"
@@ -15,42 +20,208 @@
 #include "./Interfaces/playermover.h"
 #include "mazerunnerbase.h"
 #include "playergame.h"
+#include "playerslots.h"
+#include "workerpool.h"
+#include "mazerandom.h"
+#include "replay.h"
+#include "mazesnapshot.h"
+#include "movebudget.h"
 
-#define RUNNER_TEMPLATE template<class PlayerType, class PlayerDataType, class PlayerMoveType, class Tile>
-#define RUNNER_TYPE MazeRunner<PlayerType, PlayerDataType, PlayerMoveType, Tile>
+#define RUNNER_TEMPLATE template<class PlayerType, class PlayerDataType, class PlayerMoveType, class Tile, class Components>
+#define RUNNER_TYPE MazeRunner<PlayerType, PlayerDataType, PlayerMoveType, Tile, Components>
+
+//The generator, partitioner, mover and rules a runner talks to
+//By default it goes through the virtual interfaces so any implementation
+//can be plugged in. A policy naming concrete final classes instead lets
+//the compiler call, and inline, them directly
+//Maze is the maze they all work on, with its storage
+template<class PlayerType, class PlayerDataType, class PlayerMoveType, class Tile, class MazeType = maze<Tile>>
+struct VirtualComponents
+{
+    typedef MazeType Maze;
+    typedef MazeGenerator<Tile, Maze> Generator;
+    typedef MazePartitioner<PlayerDataType, Tile, Maze> Partitioner;
+    typedef PlayerMover<PlayerDataType, PlayerMoveType, Tile, Maze> Mover;
+    typedef RuleEnforcer<PlayerType, PlayerDataType, Tile, Maze> Rules;
+};
 
 //Facilitates creating a maze and letting players
 //take turns moving through it until end conditions are met
 //mazes are defined with 0, 0 in the northwest corner
-RUNNER_TEMPLATE
-class MazeRunner : public MazeRunnerBase, public MazeRunnerAccess<PlayerType, PlayerDataType, Tile>, public PlayerGame<PlayerType>
+template<class PlayerType, class PlayerDataType, class PlayerMoveType, class Tile,
+         class Components = VirtualComponents<PlayerType, PlayerDataType, PlayerMoveType, Tile>>
+class MazeRunner : public MazeRunnerBase, public MazeRunnerAccess<PlayerType, PlayerDataType, Tile, typename Components::Maze>, public PlayerGame<PlayerType>
 {
-    MazeGenerator<Tile>* _gen;
-    MazePartitioner<PlayerDataType, Tile>* _part;
-    PlayerMover<PlayerDataType, PlayerMoveType, Tile>* _move;
-    RuleEnforcer<PlayerType, PlayerDataType, Tile>* _rules;
+    typedef typename Components::Maze Maze;
+    typedef typename Components::Generator Generator;
+    typedef typename Components::Partitioner Partitioner;
+    typedef typename Components::Mover Mover;
+    typedef typename Components::Rules Rules;
+
+    Generator* _gen;
+    Partitioner* _part;
+    Mover* _move;
+    Rules* _rules;
     
-    maze<Tile> _m;
+    Maze _m;
     unsigned int _max_turn;
     unsigned int _seed;
+    unsigned int _gameSeed = 0;
+
+    //When set, player moves are computed on the pool's threads
+    //Each player gets a private copy of its section since partitioners reuse their buffers
+    WorkerPool* _pool = nullptr;
+    std::vector<std::vector<Tile>> _sections;
+
+    struct PendingMove
+    {
+        uint slot;
+        PlayerType* player;
+        PlayerMoveType* out;
+        std::vector<Tile>* section;
+        unsigned int w, h;
+        point relative;
+        double seconds;
+
+        //Returns the CPU time the player says the move took, below 0 if it doesn't know
+        double run()
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            *out = player->move(section->data(), w, h, relative.x, relative.y);
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            return player->lastMoveCpuSeconds();
+        }
+    };
+    std::vector<PendingMove> _pending;
+
+    //Runs every pending move, keeping one on the calling thread
+    //so a tick with a single mover never waits on the pool
+    void _collectPendingMoves();
+
+    //While a move budget is set every player thinks on its own thread,
+    //with its own section and move buffers since a late move can still
+    //be using them after the runner has given up on it
+    struct BudgetedPlayer
+    {
+        PlayerWorker worker;
+        std::vector<Tile> section;
+        PlayerMoveType move;
+    };
+    MoveBudget _budget;
+    std::vector<std::unique_ptr<BudgetedPlayer>> _budgeted;
+
+    BudgetedPlayer& _budgetedPlayer(uint slot);
+
+    //Charges the player for a move that finished since it was last checked
+    void _collectMoveTiming(uint slot);
+
+    //False while the player is still on a late move or out of game budget
+    bool _playerMayMove(uint slot);
+
+    //Waits for every pending move up to its deadline
+    void _collectBudgetedMoves();
+
+    //Players whose late move outlasted the grace period. Their worker and
+    //buffers are leaked to the thread still running the move, and the
+    //player is never handed back to be destroyed
+    std::vector<PlayerType*> _abandoned;
+
+    //Waits up to the grace period for the slot's late move, if it has one
+    //Abandons the move and the player and returns false if it doesn't return
+    bool _finishLateMove(uint slot);
+
+    //Event scheduler state. Each entry is the next tick a player
+    //has to act on, paired with its slot
+    typedef std::pair<uint, uint> Event;
+    typedef std::priority_queue<Event, std::vector<Event>, std::greater<Event>> EventQueue;
+    bool _scheduled = false;
+    EventQueue _events;
+    std::vector<uint> _due;
+
+    //Replay recording and playback, either may be null
+    //_asked holds the slots whose moves came from a player this tick
+    ReplayRecorder<PlayerDataType, PlayerMoveType>* _recorder = nullptr;
+    ReplayPlayback<PlayerDataType, PlayerMoveType>* _playback = nullptr;
+    std::vector<uint> _asked;
+
+    void _setupFromPlayback(MazeRandom& mazeRng);
+
+    MazeSnapshotter<Maze> _snapshotter;
+
+    //Fills _due with the slots which act this tick
+    //Returns false when no player has anything left to do
+    bool _findDuePlayers();
+    void _rebuildSchedule();
 
 protected:
     uint _turn_no;
-    std::vector<PlayerType*> _playerList;
-    std::unordered_map<PlayerType*, PlayerDataType> _players;
-    std::unordered_map<PlayerType*, PlayerMoveType> _moves;
+    PlayerSlots<PlayerType, PlayerDataType, PlayerMoveType> _slots;
 
 public:
-    MazeRunner(MazeGenerator<Tile>* gen, MazePartitioner<PlayerDataType, Tile>* part, PlayerMover<PlayerDataType, PlayerMoveType, Tile>* move, 
-               RuleEnforcer<PlayerType, PlayerDataType, Tile>* rules,
+    typedef GameSnapshot<PlayerDataType, Maze> Snapshot;
+
+    MazeRunner(Generator* gen, Partitioner* part, Mover* move, Rules* rules,
                unsigned int max_turns, unsigned int seed = 0);
     ~MazeRunner();
 
-    maze<Tile>& getMaze() { return _m; }
-    std::unordered_map<PlayerType*, PlayerDataType>* getPlayerData(){return &_players;}
+    Maze& getMaze() { return _m; }
+
+    //Seed the current game was set up with, even when the runner picked one from the clock
+    unsigned int gameSeed() const { return _gameSeed; }
+
+    PlayerDataView<PlayerType, PlayerDataType> getPlayerData(){return _slots.view();}
+
+    //Per slot results, slots are numbered in the order players were added
+    unsigned int playerSlots() const {return _slots.size();}
+    PlayerType* slotPlayer(unsigned int slot) {return _slots.player(slot);}
+    int finishTurn(unsigned int slot) {return _slots.finishTurn(slot);}
+    const std::string& slotName(unsigned int slot) {return _slots.name(slot);}
+    const MoveStats& moveStats(unsigned int slot) {return _slots.stats(slot);}
+    uint currentTurn() const {return _turn_no;}
 
     void addPlayer(PlayerType* p);
-    void removePlayer(PlayerType* p);
+    //Returns false if the player was abandoned on a move that never
+    //returned, in which case it must not be destroyed or unloaded
+    bool removePlayer(PlayerType* p);
+
+    //Runs player moves on this many worker threads
+    //0 or 1 computes moves serially on the calling thread
+    void setWorkerThreads(unsigned int threads);
+
+    //When enabled, tickGame only visits players on ticks where the
+    //mover says they can do something, jumping the turn counter over
+    //ticks where everyone is waiting out a move
+    void useEventScheduler(bool enabled);
+
+    //Limits how long players may take to move. A player that runs over
+    //forfeits the turn and gets the mover's default move instead, and is
+    //skipped until its late move returns. Moves run on one thread per
+    //player while a budget is set, in place of the worker pool
+    void setMoveBudget(const MoveBudget& budget){_budget = budget;}
+
+    //Writes each player's move counts and latency histogram
+    void printMoveStats(std::ostream& out);
+
+    //Records every game set up from now on. Pass nullptr to stop recording
+    void recordTo(ReplayRecorder<PlayerDataType, PlayerMoveType>* recorder){_recorder = recorder;}
+
+    //Plays back a recorded game instead of asking players for moves
+    //setup() regenerates the maze from the recorded seed, so the runner's
+    //generator must be configured the same way as when it was recorded.
+    //The recorded players replace any players added to the runner
+    void replayFrom(ReplayPlayback<PlayerDataType, PlayerMoveType>* playback){_playback = playback;}
+
+    //Captures the game between ticks: the maze, every slot's data and
+    //the mover's memory. Players' own memory and random streams are not
+    //part of the game and are left to the players
+    Snapshot snapshot();
+
+    //Carries on from a snapshot taken by this runner or any other one with
+    //the same number of player slots, and the same scheduler setting.
+    //Only maze chunks that differ from the snapshot are copied, so going
+    //back to the same snapshot again and again is cheap.
+    //Returns false if the player slots don't match
+    bool restore(const Snapshot& s);
 
     //Gets moves from all players and then
     //executes the moves
@@ -64,8 +235,8 @@ public:
 };
 
 RUNNER_TEMPLATE
-RUNNER_TYPE::MazeRunner(MazeGenerator<Tile>* gen, MazePartitioner<PlayerDataType, Tile>* part, PlayerMover<PlayerDataType, PlayerMoveType, Tile>* move, 
-               RuleEnforcer<PlayerType, PlayerDataType, Tile>* rules, unsigned int max_turns, unsigned int seed) 
+RUNNER_TYPE::MazeRunner(Generator* gen, Partitioner* part, Mover* move, Rules* rules,
+               unsigned int max_turns, unsigned int seed) 
 : _gen(gen), _part(part), _move(move), _rules(rules), _max_turn(max_turns), _seed(seed)
 {
 
@@ -74,19 +245,223 @@ RUNNER_TYPE::MazeRunner(MazeGenerator<Tile>* gen, MazePartitioner<PlayerDataType
 RUNNER_TEMPLATE
 RUNNER_TYPE::~MazeRunner()
 {
+    for(uint i=0; i<_budgeted.size(); i++)
+        _finishLateMove(i);
+    delete _pool;
     _m.destroy();
 }
 
+RUNNER_TEMPLATE
+void RUNNER_TYPE::setWorkerThreads(unsigned int threads)
+{
+    delete _pool;
+    _pool = nullptr;
+
+    if(threads > 1)
+        _pool = new WorkerPool(threads);
+}
+
+RUNNER_TEMPLATE
+void RUNNER_TYPE::useEventScheduler(bool enabled)
+{
+    _scheduled = enabled;
+    if(_scheduled && _m.valid())
+        _rebuildSchedule();
+}
+
+RUNNER_TEMPLATE
+void RUNNER_TYPE::_collectPendingMoves()
+{
+    for(unsigned int i=1; i<_pending.size(); i++)
+    {
+        PendingMove* job = &_pending[i];
+        _pool->push([job](){job->run();});
+    }
+
+    _pending[0].run();
+    if(_pending.size() > 1)
+        _pool->wait();
+
+    for(const PendingMove& job : _pending)
+        _slots.stats(job.slot).latency.record(job.seconds);
+    _pending.clear();
+}
+
+RUNNER_TEMPLATE
+typename RUNNER_TYPE::BudgetedPlayer& RUNNER_TYPE::_budgetedPlayer(uint slot)
+{
+    if(_budgeted.size() <= slot)
+        _budgeted.resize(slot+1);
+    if(!_budgeted[slot])
+        _budgeted[slot].reset(new BudgetedPlayer());
+    return *_budgeted[slot];
+}
+
+RUNNER_TEMPLATE
+void RUNNER_TYPE::_collectMoveTiming(uint slot)
+{
+    double cpu, wall;
+    if(slot < _budgeted.size() && _budgeted[slot] && _budgeted[slot]->worker.collect(cpu, wall))
+    {
+        MoveStats& stats = _slots.stats(slot);
+        stats.cpuSeconds += cpu;
+        stats.latency.record(wall);
+    }
+}
+
+RUNNER_TEMPLATE
+bool RUNNER_TYPE::_playerMayMove(uint slot)
+{
+    _collectMoveTiming(slot);
+    if(_budgetedPlayer(slot).worker.busy())
+        return false;
+
+    return _budget.gameSeconds <= 0 || _slots.stats(slot).cpuSeconds < _budget.gameSeconds;
+}
+
+RUNNER_TEMPLATE
+void RUNNER_TYPE::_collectBudgetedMoves()
+{
+    typedef std::chrono::steady_clock clock;
+
+    for(const PendingMove& job : _pending)
+    {
+        PendingMove copy = job;
+        _budgeted[job.slot]->worker.start([copy]() mutable {return copy.run();});
+    }
+
+    //Every move was started at once, so they all count from here
+    clock::time_point start = clock::now();
+    for(const PendingMove& job : _pending)
+    {
+        BudgetedPlayer& p = *_budgeted[job.slot];
+        MoveStats& stats = _slots.stats(job.slot);
+
+        double limit = _budget.callSeconds;
+        if(_budget.gameSeconds > 0)
+        {
+            double left = _budget.gameSeconds - stats.cpuSeconds;
+            if(limit <= 0 || left < limit)
+                limit = left;
+        }
+
+        bool done = true;
+        if(limit > 0)
+            done = p.worker.waitUntil(start + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(limit)));
+        else
+            p.worker.wait();
+
+        if(done)
+        {
+            _slots.move(job.slot) = p.move;
+            _collectMoveTiming(job.slot);
+        }
+        else
+        {
+            _slots.move(job.slot) = _move->defaultMove();
+            stats.timeouts++;
+        }
+    }
+
+    _pending.clear();
+}
+
+RUNNER_TEMPLATE
+bool RUNNER_TYPE::_finishLateMove(uint slot)
+{
+    if(slot >= _budgeted.size() || !_budgeted[slot])
+        return true;
+
+    PlayerWorker& worker = _budgeted[slot]->worker;
+    if(!worker.busy() || worker.waitFor(_budget.graceSeconds))
+        return true;
+
+    std::cout << "Player " << _slots.name(slot) << " is stuck in a move, abandoning it" << std::endl;
+    worker.abandon();
+    _budgeted[slot].release();
+    if(_slots.player(slot))
+    {
+        _slots.player(slot)->abandon();
+        _abandoned.push_back(_slots.player(slot));
+        _slots.remove(_slots.player(slot));
+    }
+    _slots.stats(slot).forfeits++;
+    return false;
+}
+
+RUNNER_TEMPLATE
+void RUNNER_TYPE::printMoveStats(std::ostream& out)
+{
+    for(uint i=0; i<_slots.size(); i++)
+    {
+        if(!_slots.active(i)) continue;
+
+        _collectMoveTiming(i);
+        out << _slots.name(i) << ": ";
+        _slots.stats(i).print(out);
+    }
+}
+
 RUNNER_TEMPLATE
 void RUNNER_TYPE::addPlayer(PlayerType* p)
 {
-    _playerList.push_back(p);
+    _slots.add(p);
+    _sections.emplace_back();
 }
 
 RUNNER_TEMPLATE
-void RUNNER_TYPE::removePlayer(PlayerType* p)
+bool RUNNER_TYPE::removePlayer(PlayerType* p)
 {
-    _players.erase(p);
+    //The player can't go away while it is still working on a late move
+    for(uint i=0; i<_slots.size() && i<_budgeted.size(); i++)
+    {
+        if(_slots.player(i) == p)
+            _finishLateMove(i);
+    }
+    _slots.remove(p);
+    return std::find(_abandoned.begin(), _abandoned.end(), p) == _abandoned.end();
+}
+
+RUNNER_TEMPLATE
+bool RUNNER_TYPE::_findDuePlayers()
+{
+    _due.clear();
+    if(!_scheduled)
+    {
+        for(uint i=0; i<_slots.size(); i++)
+        {
+            if(_slots.active(i) && !_rules->playerIsDone(_slots.data(i), _m))
+                _due.push_back(i);
+        }
+        return _due.size() > 0;
+    }
+
+    //Jump straight to the next tick where someone has something to do
+    //Equal ticks pop in slot order, matching the serial loop
+    while(_events.size() && !_slots.active(_events.top().second))
+        _events.pop();
+
+    if(_events.empty()) return false;
+
+    _turn_no = _events.top().first;
+    while(_events.size() && _events.top().first == _turn_no)
+    {
+        if(_slots.active(_events.top().second))
+            _due.push_back(_events.top().second);
+        _events.pop();
+    }
+    return true;
+}
+
+RUNNER_TEMPLATE
+void RUNNER_TYPE::_rebuildSchedule()
+{
+    _events = EventQueue();
+    for(uint i=0; i<_slots.size(); i++)
+    {
+        if(_slots.active(i) && !_rules->playerIsDone(_slots.data(i), _m))
+            _events.push(std::make_pair(_turn_no, i));
+    }
 }
 
 RUNNER_TEMPLATE
@@ -98,53 +473,109 @@ bool RUNNER_TYPE::tickGame()
     do
     {
         //std::cerr << "Start" << std::endl;
+        if(!_findDuePlayers())
+        {
+            std::cout << "No moves!" << std::endl;
+            printMoveStats(std::cout);
+            return false;
+        }
+
+        if(_turn_no > _max_turn)
+        {
+            std::cout << "Players took too long!" << std::endl;
+            printMoveStats(std::cout);
+            return false;
+        }
+
         unsigned int w, h;
         point relative;
-        bool moves = false;
-        for(auto& p : _players)
+        for(uint i : _due)
         {
-           // std::cout << "Get player move: " << p.first << std::endl;
-            if(_rules->playerIsDone(p.second, _m)) continue;
-            moves = true;
-
-            if(!_rules->playerGetsTurn(p.second, _m))
+            PlayerDataType& data = _slots.data(i);
+            if(!_rules->playerGetsTurn(data, _m))
             {
                 //std::cerr << "Player does not get turn" << std::endl;
-                _moves[p.first] = _move->defaultMove();
+                _slots.move(i) = _move->defaultMove();
+            }
+            else if(_playback)
+            {
+                _slots.move(i) = _playback->nextMove();
             }
             else
             {
+                if(_recorder)
+                    _asked.push_back(i);
+
+                if(_budget.enabled() && !_playerMayMove(i))
+                {
+                    _slots.move(i) = _move->defaultMove();
+                    _slots.stats(i).forfeits++;
+                    continue;
+                }
+
                 //std::cerr << "Get section" << std::endl;
-                Tile* area = _part->getMazeSection(w, h, p.second, relative, _m);
+                Tile* area = _part->getMazeSection(w, h, data, relative, _m);
 
                 //std::cerr << "Get move" << std::endl;
-                _moves[p.first] = p.first->move(area, w, h, relative.x, relative.y);
+                PlayerType* player = _slots.player(i);
+                if(_budget.enabled())
+                {
+                    BudgetedPlayer& p = _budgetedPlayer(i);
+                    p.section.assign(area, area + w*h);
+                    _pending.push_back(PendingMove{i, player, &p.move, &p.section, w, h, relative, 0});
+                }
+                else if(_pool)
+                {
+                    std::vector<Tile>& section = _sections[i];
+                    section.assign(area, area + w*h);
+                    _pending.push_back(PendingMove{i, player, &_slots.move(i), &section, w, h, relative, 0});
+                }
+                else
+                {
+                    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                    _slots.move(i) = player->move(area, w, h, relative.x, relative.y);
+                    _slots.stats(i).latency.record(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+                }
             }
         }
 
-        if(!moves)
+        //Moves are applied below in the same order as the serial version
+        if(_pending.size())
         {
-            std::cout << "No moves!" << std::endl;
-            return false;
+            if(_budget.enabled())
+                _collectBudgetedMoves();
+            else
+                _collectPendingMoves();
         }
 
-        if(_turn_no > _max_turn)
-        {
-            std::cout << "Players took too long!" << std::endl;
-            return false;
-        }
+        for(uint i : _asked)
+            _recorder->recordMove(_slots.move(i));
+        _asked.clear();
 
         somePlayerMoved = false;
-        for(auto& p : _players)
+        _m.journal.setTick(_turn_no);
+        for(uint i : _due)
         {
-            if(_rules->playerIsDone(p.second, _m)) continue;
+            PlayerDataType& data = _slots.data(i);
 
-            PlayerDataType before = p.second;
-            _move->movePlayer(p.second, _moves[p.first], _m);
-            somePlayerMoved= somePlayerMoved || _rules->playerIsDifferent(before, p.second);
+            PlayerDataType before = data;
+            _move->movePlayer(data, _slots.move(i), _m);
+            somePlayerMoved= somePlayerMoved || _rules->playerIsDifferent(before, data);
 
-            if(_rules->playerIsDone(p.second, _m))
-                std::cout << "Player " << p.first->playerName() << " finished on turn " << _turn_no << std::endl;
+            if(_rules->playerIsDone(data, _m))
+            {
+                _slots.finishTurn(i) = _turn_no;
+                std::cout << "Player " << _slots.name(i) << " finished on turn " << _turn_no << std::endl;
+            }
+            else if(_scheduled)
+            {
+                //Ticks where the mover would only count down are applied
+                //now and the player sleeps until the first one that matters
+                unsigned int idle = _move->idleTicks(data);
+                if(idle)
+                    _move->skipTicks(data, idle);
+                _events.push(std::make_pair(_turn_no + 1 + idle, i));
+            }
         }
 
         _turn_no++;
@@ -160,18 +591,149 @@ void RUNNER_TYPE::setup()
 {
     _m.destroy();
 
-    std::cout << "Random seed: " << _seed << std::endl;
-    if(_seed == 0)
-        srand(time(NULL));
+    if(_playback)
+        _gameSeed = _playback->seed();
     else
-        srand(_seed);
+        _gameSeed = (_seed == 0 ? time(NULL) : _seed);
+    std::cout << "Random seed: " << _gameSeed << std::endl;
+
+    //Stream 0 builds the maze, and the slot i player draws from stream i+1
+    //No two draw from the same stream, so how many numbers one bot takes
+    //never shifts what another gets. A bot's numbers still depend on the
+    //seed and its slot, and the maze on how many slots there are, so
+    //reordering or adding bots changes both
+    MazeRandom mazeRng(_gameSeed, 0);
 
     _turn_no = 0;
-    _m = _gen->generateMaze(_playerList.size());
+    _snapshotter.reset();
+    if(_playback)
+    {
+        _setupFromPlayback(mazeRng);
+    }
+    else
+    {
+        _m = _gen->generateMaze(_slots.size(), mazeRng);
+
+        //Moves still running late from the last game would be charged to this one
+        //Players stuck on one sit this game out, and every game after
+        for(uint i=0; i<_budgeted.size(); i++)
+        {
+            double cpu, wall;
+            if(!_finishLateMove(i)) continue;
+            if(_budgeted[i]) _budgeted[i]->worker.collect(cpu, wall);
+        }
+
+        for(uint i=0; i<_slots.size(); i++)
+        {
+            _slots.finishTurn(i) = -1;
+            _slots.stats(i) = MoveStats();
+            if(_slots.active(i))
+            {
+                _slots.data(i) = _rules->initPlayer(_slots.player(i), _m);
+                _slots.name(i) = _slots.player(i)->playerName();
+                _slots.player(i)->setRandom(MazeRandom(_gameSeed, i+1));
+            }
+        }
+    }
+
+    if(_recorder)
+    {
+        std::vector<std::string> names;
+        std::vector<PlayerDataType> players;
+        for(uint i=0; i<_slots.size(); i++)
+        {
+            if(!_slots.active(i)) continue;
+            names.push_back(_slots.name(i));
+            players.push_back(_slots.data(i));
+        }
+        _recorder->begin(_gameSeed, _slots.size(), _m.width(), _m.height(), names, players);
+    }
+
+    if(_scheduled)
+        _rebuildSchedule();
+}
+
+RUNNER_TEMPLATE
+typename RUNNER_TYPE::Snapshot RUNNER_TYPE::snapshot()
+{
+    Snapshot out;
+    out.turn = _turn_no;
+    out.seed = _gameSeed;
+    out.maze = _snapshotter.capture(_m);
+
+    for(uint i=0; i<_slots.size(); i++)
+    {
+        out.players.push_back(_slots.data(i));
+        out.finishTurns.push_back(_slots.finishTurn(i));
+    }
+
+    if(_scheduled)
+    {
+        EventQueue events = _events;
+        for(; !events.empty(); events.pop())
+            out.events.push_back(events.top());
+    }
+
+    out.mover = _move->saveState();
+    return out;
+}
+
+RUNNER_TEMPLATE
+bool RUNNER_TYPE::restore(const Snapshot& s)
+{
+    if(s.players.size() != _slots.size())
+    {
+        std::cout << "Snapshot has " << s.players.size() << " player slots, game has " << _slots.size() << std::endl;
+        return false;
+    }
+
+    _turn_no = s.turn;
+    _gameSeed = s.seed;
+    _snapshotter.restore(s.maze, _m);
+
+    for(uint i=0; i<_slots.size(); i++)
+    {
+        _slots.data(i) = s.players[i];
+        _slots.finishTurn(i) = s.finishTurns[i];
+    }
+
+    _events = EventQueue();
+    if(_scheduled)
+    {
+        for(const Event& e : s.events)
+            _events.push(e);
+
+        //Snapshot came from a runner without the scheduler
+        if(s.events.empty())
+            _rebuildSchedule();
+    }
 
-    for(auto& p : _playerList)
+    _move->restoreState(s.mover.get());
+    return true;
+}
+
+RUNNER_TEMPLATE
+void RUNNER_TYPE::_setupFromPlayback(MazeRandom& mazeRng)
+{
+    //Recorded games bring their own players, which only exist as data
+    _slots.clear();
+    _sections.clear();
+
+    _m = _gen->generateMaze(_playback->mazePlayers(), mazeRng);
+    if(_m.width() != _playback->width() || _m.height() != _playback->height())
+    {
+        std::cout << "Replay was recorded on a " << _playback->width() << "x" << _playback->height()
+                  << " maze, but the generator made a " << _m.width() << "x" << _m.height() << " one" << std::endl;
+    }
+
+    for(uint i=0; i<_playback->players().size(); i++)
     {
-        _players[p] = _rules->initPlayer(p, _m);
+        uint slot = _slots.add(nullptr);
+        _sections.emplace_back();
+
+        _slots.data(slot) = _playback->players()[i];
+        _slots.name(slot) = _playback->names()[i];
+        _rules->placePlayer(_slots.data(slot), _m);
     }
 }
 
@@ -4,15 +4,14 @@
 #include "./Interfaces/backend_types.h"
 #include "./Interfaces/player.h"
 #include "types.h"
+#include "playerslots.h"
 
-#include <unordered_map>
-
-template<class PlayerType, class PlayerDataType, class Tile>
+template<class PlayerType, class PlayerDataType, class Tile, class Maze = maze<Tile>>
 class MazeRunnerAccess
 {
 public:
-    virtual maze<Tile>& getMaze() = 0;
-    virtual std::unordered_map<PlayerType*, PlayerDataType>* getPlayerData() = 0;
+    virtual Maze& getMaze() = 0;
+    virtual PlayerDataView<PlayerType, PlayerDataType> getPlayerData() = 0;
 };
 
 class MazeRunnerBase
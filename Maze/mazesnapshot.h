@@ -0,0 +1,102 @@
+#ifndef _MAZE_SNAPSHOT_H
+#define _MAZE_SNAPSHOT_H
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "./Interfaces/backend_types.h"
+#include "./Interfaces/playermover.h"
+
+//Read only copy of a maze
+//The storage saves its own tiles, sharing whatever it can with the copies
+//taken before, so snapshots taken a few turns apart cost little
+template<class Maze>
+struct MazeSnapshot
+{
+    unsigned int width = 0, height = 0;
+    bool wrapped = false;
+    std::vector<point> players;
+    point exit;
+    OccupancyIndex occupants;
+    typename Maze::StorageType::Saved tiles;
+};
+
+//Moves a running maze to and from snapshots, copying as little as it can
+//It remembers which snapshot the maze last matched, and hands it to the
+//storage so tiles unchanged since then are shared instead of copied
+template<class Maze>
+class MazeSnapshotter
+{
+    typedef typename Maze::StorageType::Saved Saved;
+    Saved _base;
+    bool _hasBase = false;
+
+public:
+    //Call when the maze is replaced by one the snapshotter has not seen
+    void reset()
+    {
+        _base = Saved();
+        _hasBase = false;
+    }
+
+    MazeSnapshot<Maze> capture(Maze& m)
+    {
+        MazeSnapshot<Maze> out;
+        out.width = m.width();
+        out.height = m.height();
+        out.wrapped = m.wrapped();
+        out.players = m.players;
+        out.exit = m.exit;
+        out.occupants = m.occupants;
+        out.tiles = m.storage().save(_hasBase ? &_base : nullptr);
+
+        _base = out.tiles;
+        _hasBase = true;
+        return out;
+    }
+
+    void restore(const MazeSnapshot<Maze>& s, Maze& m)
+    {
+        if(!m.valid() || m.width() != s.width || m.height() != s.height || m.wrapped() != s.wrapped)
+        {
+            m.destroy();
+            m = Maze(s.width, s.height, s.wrapped);
+            reset();
+        }
+
+        m.storage().restore(s.tiles, _hasBase ? &_base : nullptr);
+        m.players = s.players;
+        m.exit = s.exit;
+        m.occupants = s.occupants;
+
+        //Tiles were copied in behind the journal's back
+        m.journal.restart();
+
+        _base = s.tiles;
+        _hasBase = true;
+    }
+};
+
+//Everything a runner needs to carry on a game from the tick it was taken on
+//Snapshots are cheap to copy and can be restored any number of times,
+//into the runner they came from or another one with the same player slots
+template<class PlayerDataType, class Maze>
+struct GameSnapshot
+{
+    unsigned int turn = 0;
+    unsigned int seed = 0;
+    MazeSnapshot<Maze> maze;
+
+    //Indexed by player slot
+    std::vector<PlayerDataType> players;
+    std::vector<int> finishTurns;
+
+    //Pending (tick, slot) events when the event scheduler is in use
+    std::vector<std::pair<unsigned int, unsigned int>> events;
+
+    std::shared_ptr<const MoverState> mover;
+};
+
+#endif
@@ -0,0 +1,250 @@
+#ifndef _MOVE_BUDGET_H
+#define _MOVE_BUDGET_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <time.h>
+
+//Limits on how long players may think about their moves
+//Either limit can be 0 to leave it off
+struct MoveBudget
+{
+    //Longest one move() call may take before the player forfeits the turn
+    double callSeconds = 0;
+
+    //CPU time a player may spend in move() over a whole game. Once it is
+    //used up every later turn is forfeited
+    double gameSeconds = 0;
+
+    //How long the runner waits for a late move when the player is removed
+    //or a new game is set up. A move still running after that is abandoned
+    //on its thread, and the player sits out every game after
+    double graceSeconds = 2;
+
+    bool enabled() const {return callSeconds > 0 || gameSeconds > 0;}
+};
+
+//Counts of move() latencies in power of two microsecond buckets
+//Bucket 0 holds calls under 1us, bucket n calls from 2^(n-1) up to 2^n us
+class LatencyHistogram
+{
+public:
+    static const unsigned int BUCKETS = 32;
+
+private:
+    unsigned long long _counts[BUCKETS] = {};
+    unsigned long long _total = 0;
+    double _maxSeconds = 0;
+
+public:
+    void record(double seconds)
+    {
+        unsigned long long us = seconds*1e6;
+        unsigned int bucket = 0;
+        while(us && bucket < BUCKETS-1)
+        {
+            us >>= 1;
+            bucket++;
+        }
+        _counts[bucket]++;
+        _total++;
+        if(seconds > _maxSeconds) _maxSeconds = seconds;
+    }
+
+    unsigned long long total() const {return _total;}
+    unsigned long long count(unsigned int bucket) const {return _counts[bucket];}
+    double maxSeconds() const {return _maxSeconds;}
+
+    //Upper edge of a bucket in microseconds
+    static unsigned long long bucketLimit(unsigned int bucket) {return 1ULL << bucket;}
+
+    //Upper edge of the bucket the given fraction of calls fall under
+    unsigned long long percentile(double fraction) const
+    {
+        unsigned long long target = fraction*_total;
+        unsigned long long seen = 0;
+        for(unsigned int i=0; i<BUCKETS; i++)
+        {
+            seen += _counts[i];
+            if(seen > target) return bucketLimit(i);
+        }
+        return bucketLimit(BUCKETS-1);
+    }
+};
+
+//How one player has used its moves over a game
+struct MoveStats
+{
+    unsigned long long timeouts = 0;    //Calls that ran past their deadline
+    unsigned long long forfeits = 0;    //Turns skipped because the player was still busy or out of budget
+    double cpuSeconds = 0;              //Only measured while a budget is set
+    LatencyHistogram latency;
+
+    void print(std::ostream& out) const
+    {
+        out << latency.total() << " moves, " << timeouts << " timed out, " << forfeits << " forfeited";
+        if(cpuSeconds > 0)
+            out << ", " << cpuSeconds << "s cpu";
+        if(latency.total())
+        {
+            out << ", p50 < " << latency.percentile(0.5) << "us"
+                << ", p99 < " << latency.percentile(0.99) << "us"
+                << ", max " << latency.maxSeconds()*1e6 << "us";
+        }
+        out << std::endl;
+
+        for(unsigned int i=0; i<LatencyHistogram::BUCKETS; i++)
+        {
+            if(latency.count(i) == 0) continue;
+            out << "    < " << LatencyHistogram::bucketLimit(i) << "us: " << latency.count(i) << std::endl;
+        }
+    }
+};
+
+//Runs one player's moves on a thread of its own
+//The runner waits for a move only until its deadline. A move that runs
+//late keeps going in the background, and the worker stays busy until it
+//returns. Destroying the worker waits for any move still running, unless
+//it was abandoned
+//A job returns the CPU time it used, or a negative number to be charged
+//the CPU time of the worker's thread while it ran
+class PlayerWorker
+{
+    typedef std::chrono::steady_clock clock;
+
+    //Everything the thread touches, which outlives the worker if the thread
+    //is abandoned while a move is still running
+    struct Shared
+    {
+        std::mutex lock;
+        std::condition_variable wake;
+        std::condition_variable idle;
+        std::function<double()> job;
+        bool busy = false;
+        bool stop = false;
+
+        //Timing of the last finished job, until the runner collects it
+        bool unreported = false;
+        double cpuSeconds = 0;
+        double wallSeconds = 0;
+    };
+
+    std::shared_ptr<Shared> _shared;
+    std::thread _thread;
+
+    static double _threadCpuSeconds()
+    {
+        timespec t;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+        return t.tv_sec + t.tv_nsec*1e-9;
+    }
+
+    static void _run(std::shared_ptr<Shared> s)
+    {
+        std::unique_lock<std::mutex> lock(s->lock);
+        while(true)
+        {
+            s->wake.wait(lock, [&s](){return s->stop || s->job;});
+            if(!s->job) return;
+
+            std::function<double()> job = std::move(s->job);
+            s->job = nullptr;
+            lock.unlock();
+
+            double cpuStart = _threadCpuSeconds();
+            clock::time_point wallStart = clock::now();
+            double cpu = job();
+            double wall = std::chrono::duration<double>(clock::now() - wallStart).count();
+            if(cpu < 0)
+                cpu = _threadCpuSeconds() - cpuStart;
+
+            lock.lock();
+            s->cpuSeconds = cpu;
+            s->wallSeconds = wall;
+            s->unreported = true;
+            s->busy = false;
+            s->idle.notify_all();
+        }
+    }
+
+    void _stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_shared->lock);
+            _shared->stop = true;
+        }
+        _shared->wake.notify_all();
+    }
+
+public:
+    PlayerWorker() : _shared(std::make_shared<Shared>()), _thread(&PlayerWorker::_run, _shared){}
+
+    ~PlayerWorker()
+    {
+        if(!_thread.joinable()) return;
+        _stop();
+        _thread.join();
+    }
+
+    //Only call while the worker is not busy
+    void start(std::function<double()> job)
+    {
+        std::lock_guard<std::mutex> lock(_shared->lock);
+        _shared->job = std::move(job);
+        _shared->busy = true;
+        _shared->wake.notify_one();
+    }
+
+    //Returns false if the job is still running at the deadline
+    bool waitUntil(clock::time_point deadline)
+    {
+        std::unique_lock<std::mutex> lock(_shared->lock);
+        return _shared->idle.wait_until(lock, deadline, [this](){return !_shared->busy;});
+    }
+
+    bool waitFor(double seconds)
+    {
+        return waitUntil(clock::now() + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(seconds)));
+    }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(_shared->lock);
+        _shared->idle.wait(lock, [this](){return !_shared->busy;});
+    }
+
+    bool busy()
+    {
+        std::lock_guard<std::mutex> lock(_shared->lock);
+        return _shared->busy;
+    }
+
+    //Gives up on a move that may never return. The thread is left to finish
+    //it alone and exits once it does. Whatever the job uses has to be kept
+    //alive by the caller, since nothing tells it when the thread is done
+    void abandon()
+    {
+        if(!_thread.joinable()) return;
+        _stop();
+        _thread.detach();
+    }
+
+    //Hands out the timing of a finished job once
+    bool collect(double& cpuSeconds, double& wallSeconds)
+    {
+        std::lock_guard<std::mutex> lock(_shared->lock);
+        if(!_shared->unreported) return false;
+
+        cpuSeconds = _shared->cpuSeconds;
+        wallSeconds = _shared->wallSeconds;
+        _shared->unreported = false;
+        return true;
+    }
+};
+
+#endif
@@ -6,7 +6,9 @@ class PlayerGame
 {
 public:
     virtual void addPlayer(PlayerType* p) = 0;
-    virtual void removePlayer(PlayerType* p) = 0;
+    //Returns false if the game still has the player in use, and it must
+    //be left alive rather than destroyed
+    virtual bool removePlayer(PlayerType* p) = 0;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,74 @@
+#include <iostream>
+#include <string>
+#include <dlfcn.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "isolatedplayer.h"
+
+using namespace std;
+
+//Runs one player for an isolated game
+//Started by IsolatedPlayer as: playerhost LIBRARY FD [MEMORY_MB]
+//where FD is the shared memory holding the request and reply rings
+
+typedef void playerDestroy_t(AttributePlayer*);
+typedef AttributePlayer* playerCreate_t();
+
+int main(int argc, char *argv[])
+{
+    if(argc < 3)
+    {
+        cerr << "Usage: " << argv[0] << " LIBRARY FD [MEMORY_MB]" << endl;
+        return 1;
+    }
+
+    //Parent may have died before this process was told to follow it
+    pid_t parent = getppid();
+    if(parent == 1) return 1;
+
+    string library = argv[1];
+    int fd = stoi(argv[2]);
+    unsigned long memoryLimit = argc > 3 ? stoul(argv[3]) : 0;
+
+    size_t ringSize = SharedRing::bytesNeeded(IsolatedPlayer::RING_CAPACITY);
+    void* memory = mmap(nullptr, ringSize*2, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(memory == MAP_FAILED)
+    {
+        cerr << "Unable to map shared memory" << endl;
+        return 1;
+    }
+    SharedRing requests(memory, IsolatedPlayer::RING_CAPACITY, false);
+    SharedRing replies((unsigned char*)memory + ringSize, IsolatedPlayer::RING_CAPACITY, false);
+
+    if(memoryLimit)
+    {
+        rlimit limit;
+        limit.rlim_cur = limit.rlim_max = memoryLimit*1024*1024;
+        setrlimit(RLIMIT_AS, &limit);
+    }
+
+    void* handle = dlopen(library.c_str(), RTLD_LAZY);
+    if(handle == nullptr)
+    {
+        cerr << "Unable to open library " << library << endl;
+        return 1;
+    }
+
+    playerCreate_t* createFunc = (playerCreate_t*) dlsym(handle, "createPlayer");
+    playerDestroy_t* destroyFunc = (playerDestroy_t*) dlsym(handle, "destroyPlayer");
+    AttributePlayer* player = createFunc ? createFunc() : nullptr;
+    if(player == nullptr || destroyFunc == nullptr)
+    {
+        cerr << "Unable to create player from " << library << endl;
+        return 1;
+    }
+
+    int result = serveIsolatedPlayer(player, requests, replies, parent);
+
+    destroyFunc(player);
+    dlclose(handle);
+    return result;
+}
@@ -10,6 +10,7 @@
 #include <dlfcn.h>
 
 #include "playergame.h"
+#include "isolatedplayer.h"
 #include "./Interfaces/player.h"
 
 template<class PlayerType>
@@ -24,15 +25,22 @@ class PlayerLoader
         PlayerType* ptr;
         playerCreate_t* createFunc;
         playerDestroy_t* destroyFunc;
-        void* library;
+        void* library;      //nullptr for isolated players
     };
 
     std::vector<playerHandle> _players;
     PlayerGame<PlayerType>* _game;
+
+    bool _isolated = false;
+    IsolationSettings _isolation;
 public:
     PlayerLoader(PlayerGame<PlayerType>* game);
     ~PlayerLoader();
 
+    //Players loaded after this run in processes of their own, so one
+    //crashing or running out of memory can't take the game with it
+    void isolatePlayers(const IsolationSettings& settings) {_isolated = true; _isolation = settings;}
+
     void unloadPlayers();
     void loadPlayers(std::string dir);
 };
@@ -55,10 +63,20 @@ void PlayerLoader<PlayerType>::unloadPlayers()
 {
     for(playerHandle& p : _players)
     {
-        _game->removePlayer(p.ptr);
-        p.destroyFunc(p.ptr);
-        dlclose(p.library);
+        //A player abandoned mid move may still be running its code, so it
+        //and its library stay loaded
+        if(!_game->removePlayer(p.ptr))
+            continue;
+
+        if(p.library)
+        {
+            p.destroyFunc(p.ptr);
+            dlclose(p.library);
+        }
+        else
+            delete p.ptr;
     }
+    _players.clear();
 }
 
 template<class PlayerType>
@@ -80,6 +98,19 @@ void PlayerLoader<PlayerType>::loadPlayers(std::string dir)
 
             std::string path = dir + "/" + fileName;
             std::cout << "Loading player from" << path << std::endl;
+            if(_isolated)
+            {
+                newPlayer.ptr = createIsolatedPlayer<PlayerType>(path, _isolation);
+                newPlayer.library = nullptr;
+                if(newPlayer.ptr)
+                {
+                    _game->addPlayer(newPlayer.ptr);
+                    std::cout << "Added isolated player " << newPlayer.ptr->playerName() << std::endl;
+                    _players.push_back(newPlayer);
+                }
+                continue;
+            }
+
             newPlayer.library = dlopen(path.c_str(), RTLD_LAZY);
             if(newPlayer.library == nullptr)
             {
@@ -0,0 +1,137 @@
+#ifndef _PLAYER_SLOTS_H
+#define _PLAYER_SLOTS_H
+
+#include <string>
+#include <vector>
+
+#include "movebudget.h"
+
+//Cheap view over the players in a game and their current data
+//Iterates the occupied slots in slot order
+template<class PlayerType, class PlayerDataType>
+class PlayerDataView
+{
+public:
+    struct entry
+    {
+        unsigned int slot;
+        PlayerType* player;
+        PlayerDataType& data;
+    };
+
+    class iterator
+    {
+        friend class PlayerDataView;
+        const PlayerDataView* _view;
+        unsigned int _slot;
+
+        iterator(const PlayerDataView* view, unsigned int slot) : _view(view), _slot(slot)
+        {
+            _skipEmpty();
+        }
+
+        void _skipEmpty()
+        {
+            while(_slot < _view->_count && !_view->_active[_slot]) _slot++;
+        }
+
+    public:
+        bool operator == (const iterator& other) const {return _slot == other._slot;}
+        bool operator != (const iterator& other) const {return _slot != other._slot;}
+
+        iterator& operator++(){_slot++; _skipEmpty(); return *this;}
+
+        entry operator*() const {return entry{_slot, _view->_players[_slot], _view->_data[_slot]};}
+    };
+
+private:
+    PlayerType* const* _players = nullptr;
+    PlayerDataType* _data = nullptr;
+    const unsigned char* _active = nullptr;
+    unsigned int _count = 0;
+
+public:
+    PlayerDataView(){}
+    PlayerDataView(PlayerType* const* players, PlayerDataType* data, const unsigned char* active, unsigned int count) :
+        _players(players), _data(data), _active(active), _count(count){}
+
+    iterator begin() const {return iterator(this, 0);}
+    iterator end() const {return iterator(this, _count);}
+};
+
+//Dense table of the players in a game, indexed by slot number
+//Each field lives in its own contiguous array so the tick loop only
+//touches the fields it needs. Slots are never reused, so a slot number
+//stays valid for a player for as long as it is in the game
+template<class PlayerType, class PlayerDataType, class PlayerMoveType>
+class PlayerSlots
+{
+    std::vector<PlayerType*> _players;
+    std::vector<PlayerDataType> _data;
+    std::vector<PlayerMoveType> _moves;
+    std::vector<unsigned char> _active;
+    std::vector<int> _finishTurns;
+    std::vector<std::string> _names;
+    std::vector<MoveStats> _stats;
+
+public:
+    unsigned int add(PlayerType* p)
+    {
+        _players.push_back(p);
+        _data.push_back(PlayerDataType());
+        _moves.push_back(PlayerMoveType());
+        _active.push_back(true);
+        _finishTurns.push_back(-1);
+        _names.push_back("");
+        _stats.push_back(MoveStats());
+        return _players.size()-1;
+    }
+
+    void clear()
+    {
+        _players.clear();
+        _data.clear();
+        _moves.clear();
+        _active.clear();
+        _finishTurns.clear();
+        _names.clear();
+        _stats.clear();
+    }
+
+    void remove(PlayerType* p)
+    {
+        for(unsigned int i=0; i<_players.size(); i++)
+        {
+            if(_players[i] == p)
+            {
+                _active[i] = false;
+                _players[i] = nullptr;
+            }
+        }
+    }
+
+    //Number of slots, including ones whose player was removed
+    unsigned int size() const {return _players.size();}
+
+    bool active(unsigned int slot) const {return _active[slot];}
+    PlayerType* player(unsigned int slot) {return _players[slot];}
+    PlayerDataType& data(unsigned int slot) {return _data[slot];}
+    PlayerMoveType& move(unsigned int slot) {return _moves[slot];}
+
+    //Turn the player reached the exit on, -1 until then
+    int& finishTurn(unsigned int slot) {return _finishTurns[slot];}
+
+    //Player's name as of the last setup, kept so slots can be
+    //reported on without calling into the player
+    std::string& name(unsigned int slot) {return _names[slot];}
+
+    //Move timing for the current game
+    MoveStats& stats(unsigned int slot) {return _stats[slot];}
+
+    PlayerDataView<PlayerType, PlayerDataType> view()
+    {
+        return PlayerDataView<PlayerType, PlayerDataType>(_players.data(), _data.data(), _active.data(), _players.size());
+    }
+};
+
+#endif
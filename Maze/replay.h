@@ -0,0 +1,413 @@
+#ifndef _REPLAY_H
+#define _REPLAY_H
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "types.h"
+#include "attributeTypes.h"
+#include "./Interfaces/backend_types.h"
+
+/*
+ *  Replay files
+ *
+ *  A replay holds everything needed to play a game again without the bots:
+ *  the seed and player count the maze was generated from, each player's starting data, and
+ *  every move a player returned when it was asked for one, in the order the
+ *  runner asked. Ticks where the runner used the mover's default move are
+ *  not stored since the runner recreates them itself.
+ *
+ *  All numbers are LEB128 varints, signed ones zigzag encoded first.
+ *  Each move starts with a tag byte:
+ *      bits 0-2  move type, or REPLAY_NOOP_RUN for a run of NOOPs
+ *      bits 3-6  direction
+ *      bit 7     MOVETO destination follows as two signed varints,
+ *                otherwise it is the unit step in the tag's direction
+ *  A run tag is followed by the number of NOOPs in the run.
+ */
+
+const char REPLAY_MAGIC[4] = {'M', 'Z', 'R', 'P'};
+const unsigned int REPLAY_VERSION = 1;
+const unsigned char REPLAY_NOOP_RUN = 7;
+const unsigned char REPLAY_END = 0xFF;
+
+class ReplayWriter
+{
+    std::vector<unsigned char> _buf;
+
+public:
+    const std::vector<unsigned char>& data() const {return _buf;}
+    void clear() {_buf.clear();}
+
+    void putByte(unsigned char b) {_buf.push_back(b);}
+
+    void putVarint(uint64_t v)
+    {
+        while(v >= 0x80)
+        {
+            _buf.push_back((unsigned char)(v | 0x80));
+            v >>= 7;
+        }
+        _buf.push_back((unsigned char)v);
+    }
+
+    void putSigned(int64_t v)
+    {
+        putVarint(((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+    }
+
+    void putString(const std::string& s)
+    {
+        putVarint(s.size());
+        _buf.insert(_buf.end(), s.begin(), s.end());
+    }
+};
+
+class ReplayReader
+{
+    std::vector<unsigned char> _buf;
+    size_t _pos = 0;
+    bool _good = true;
+
+public:
+    ReplayReader(){}
+    ReplayReader(std::vector<unsigned char> data) : _buf(std::move(data)){}
+
+    //Starts reading from data, handing back the old buffer in its place
+    //so callers reading many messages can reuse the allocations
+    void reset(std::vector<unsigned char>& data)
+    {
+        _buf.swap(data);
+        _pos = 0;
+        _good = true;
+    }
+
+    //Reading past the end returns zeros and clears good()
+    bool good() const {return _good;}
+    bool atEnd() const {return _pos >= _buf.size();}
+
+    unsigned char getByte()
+    {
+        if(_pos >= _buf.size())
+        {
+            _good = false;
+            return 0;
+        }
+        return _buf[_pos++];
+    }
+
+    unsigned char peekByte() const {return _pos < _buf.size() ? _buf[_pos] : REPLAY_END;}
+
+    uint64_t getVarint()
+    {
+        uint64_t v = 0;
+        for(unsigned int shift = 0; shift < 64; shift += 7)
+        {
+            unsigned char b = getByte();
+            v |= (uint64_t)(b & 0x7F) << shift;
+            if(!(b & 0x80)) break;
+        }
+        return v;
+    }
+
+    int64_t getSigned()
+    {
+        uint64_t v = getVarint();
+        return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+    }
+
+    std::string getString()
+    {
+        uint64_t len = getVarint();
+        if(len > _buf.size() - _pos)
+        {
+            _good = false;
+            return "";
+        }
+        std::string out(_buf.begin() + _pos, _buf.begin() + _pos + len);
+        _pos += len;
+        return out;
+    }
+};
+
+/*
+ *  Per type encoders. A runner can only record or replay games whose
+ *  player data and move types have these overloads
+ */
+
+inline MazePoint replayUnitStep(unsigned char dir)
+{
+    switch(dir)
+    {
+        case (unsigned char)AdvancedMapTile::Direction::NORTH: return MazePoint{0, -1};
+        case (unsigned char)AdvancedMapTile::Direction::SOUTH: return MazePoint{0, 1};
+        case (unsigned char)AdvancedMapTile::Direction::EAST: return MazePoint{1, 0};
+        case (unsigned char)AdvancedMapTile::Direction::WEST: return MazePoint{-1, 0};
+        default: return MazePoint{0, 0};
+    }
+}
+
+inline bool replayIsNoop(const AdvancedPlayerMove& m) {return m.attemptedMove == AdvancedPlayerMove::Move::NOOP;}
+inline bool replayIsNoop(const PlayerMove& m) {return m.attemptedMove == PlayerMove::Move::NOOP;}
+
+inline void replayWrite(ReplayWriter& out, const AdvancedPlayerMove& m)
+{
+    unsigned char dir = (unsigned char)m.dir & 0x0F;
+    unsigned char tag = (unsigned char)m.attemptedMove | (dir << 3);
+
+    MazePoint unit = replayUnitStep(dir);
+    bool explicitDest = m.attemptedMove == AdvancedPlayerMove::Move::MOVETO &&
+                        (m.destination.x != unit.x || m.destination.y != unit.y);
+    if(explicitDest) tag |= 0x80;
+
+    out.putByte(tag);
+    if(explicitDest)
+    {
+        out.putSigned(m.destination.x);
+        out.putSigned(m.destination.y);
+    }
+}
+
+inline void replayRead(ReplayReader& in, unsigned char tag, AdvancedPlayerMove& m)
+{
+    unsigned char dir = (tag >> 3) & 0x0F;
+    m = AdvancedPlayerMove((AdvancedMapTile::Direction)dir);
+    m.attemptedMove = (AdvancedPlayerMove::Move)(tag & 0x07);
+    m.dir = (AdvancedMapTile::Direction)dir;
+    m.destination = replayUnitStep(dir);
+    if(tag & 0x80)
+    {
+        m.destination.x = in.getSigned();
+        m.destination.y = in.getSigned();
+    }
+}
+
+inline void replayWrite(ReplayWriter& out, const PlayerMove& m)
+{
+    out.putByte((unsigned char)m.attemptedMove | 0x80);
+    out.putSigned(m.destination.x);
+    out.putSigned(m.destination.y);
+}
+
+inline void replayRead(ReplayReader& in, unsigned char tag, PlayerMove& m)
+{
+    m = PlayerMove();
+    m.attemptedMove = (PlayerMove::Move)(tag & 0x07);
+    if(tag & 0x80)
+    {
+        m.destination.x = in.getSigned();
+        m.destination.y = in.getSigned();
+    }
+}
+
+inline void replayWrite(ReplayWriter& out, const AdvancedPlayerData& d)
+{
+    out.putVarint(d.x);
+    out.putVarint(d.y);
+    out.putSigned(d.id);
+    out.putSigned(d.ticksPerTurn);
+    out.putSigned(d.mapVisionDist);
+    out.putSigned(d.playerVisionDist);
+    out.putSigned(d.ticksLeftForCurrentMove);
+    out.putSigned(d.wallBreaksLeft);
+    out.putSigned(d.wallPhaseLeft);
+    out.putSigned(d.luckLeft);
+    out.putSigned(d.stickyBombAvoids);
+    out.putSigned(d.stickyBombs);
+    replayWrite(out, d.moveInProgress);
+}
+
+inline void replayRead(ReplayReader& in, AdvancedPlayerData& d)
+{
+    d.x = in.getVarint();
+    d.y = in.getVarint();
+    d.id = in.getSigned();
+    d.ticksPerTurn = in.getSigned();
+    d.mapVisionDist = in.getSigned();
+    d.playerVisionDist = in.getSigned();
+    d.ticksLeftForCurrentMove = in.getSigned();
+    d.wallBreaksLeft = in.getSigned();
+    d.wallPhaseLeft = in.getSigned();
+    d.luckLeft = in.getSigned();
+    d.stickyBombAvoids = in.getSigned();
+    d.stickyBombs = in.getSigned();
+    replayRead(in, in.getByte(), d.moveInProgress);
+}
+
+inline void replayWrite(ReplayWriter& out, const BasicPlayerData& d)
+{
+    out.putVarint(d.x);
+    out.putVarint(d.y);
+    out.putSigned(d.id);
+}
+
+inline void replayRead(ReplayReader& in, BasicPlayerData& d)
+{
+    d.x = in.getVarint();
+    d.y = in.getVarint();
+    d.id = in.getSigned();
+}
+
+//Records one game to a replay file
+//The runner calls begin() from setup and recordMove() for every move a
+//player returns. The file is complete once close() is called or the
+//recorder is destroyed
+template<class PlayerDataType, class PlayerMoveType>
+class ReplayRecorder
+{
+    std::string _path;
+    ReplayWriter _out;
+    uint64_t _noops = 0;
+    bool _open = false;
+
+    void _flushNoops()
+    {
+        if(_noops == 0) return;
+
+        _out.putByte(REPLAY_NOOP_RUN);
+        _out.putVarint(_noops);
+        _noops = 0;
+    }
+
+public:
+    ReplayRecorder(const std::string& path) : _path(path){}
+    ~ReplayRecorder() {close();}
+
+    //mazePlayers is the player count the maze was generated for, which can
+    //include slots that were empty by the time the game started
+    void begin(unsigned int seed, unsigned int mazePlayers, unsigned int width, unsigned int height,
+               const std::vector<std::string>& names, const std::vector<PlayerDataType>& players)
+    {
+        _out.clear();
+        _noops = 0;
+        _open = true;
+
+        for(char c : REPLAY_MAGIC) _out.putByte(c);
+        _out.putVarint(REPLAY_VERSION);
+        _out.putVarint(seed);
+        _out.putVarint(mazePlayers);
+        _out.putVarint(width);
+        _out.putVarint(height);
+        _out.putVarint(players.size());
+        for(unsigned int i=0; i<players.size(); i++)
+        {
+            _out.putString(names[i]);
+            replayWrite(_out, players[i]);
+        }
+    }
+
+    void recordMove(const PlayerMoveType& move)
+    {
+        if(replayIsNoop(move))
+        {
+            _noops++;
+            return;
+        }
+
+        _flushNoops();
+        replayWrite(_out, move);
+    }
+
+    //Writes the file. Returns false if it could not be written
+    bool close()
+    {
+        if(!_open) return true;
+        _open = false;
+
+        _flushNoops();
+        _out.putByte(REPLAY_END);
+
+        std::ofstream file(_path, std::ios::binary);
+        file.write((const char*)_out.data().data(), _out.data().size());
+        return file.good();
+    }
+};
+
+//Reads a replay file back and hands out the recorded moves in order
+template<class PlayerDataType, class PlayerMoveType>
+class ReplayPlayback
+{
+    ReplayReader _in;
+    unsigned int _seed = 0, _mazePlayers = 0, _width = 0, _height = 0;
+    std::vector<std::string> _names;
+    std::vector<PlayerDataType> _players;
+    uint64_t _noops = 0;
+    bool _ended = false;
+
+public:
+    //Returns false if the file is missing or not a replay this build understands
+    bool load(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if(!file) return false;
+
+        _in = ReplayReader(std::vector<unsigned char>((std::istreambuf_iterator<char>(file)),
+                                                      std::istreambuf_iterator<char>()));
+        for(char c : REPLAY_MAGIC)
+            if(_in.getByte() != (unsigned char)c) return false;
+        if(_in.getVarint() != REPLAY_VERSION) return false;
+
+        _seed = _in.getVarint();
+        _mazePlayers = _in.getVarint();
+        _width = _in.getVarint();
+        _height = _in.getVarint();
+
+        unsigned int count = _in.getVarint();
+        _names.clear();
+        _players.clear();
+        for(unsigned int i=0; i<count && _in.good(); i++)
+        {
+            _names.push_back(_in.getString());
+            _players.push_back(PlayerDataType());
+            replayRead(_in, _players.back());
+        }
+
+        _noops = 0;
+        _ended = false;
+        return _in.good();
+    }
+
+    unsigned int seed() const {return _seed;}
+    unsigned int mazePlayers() const {return _mazePlayers;}
+    unsigned int width() const {return _width;}
+    unsigned int height() const {return _height;}
+    const std::vector<std::string>& names() const {return _names;}
+    const std::vector<PlayerDataType>& players() const {return _players;}
+
+    //True once every recorded move has been handed out
+    bool finished() const {return _ended && _noops == 0;}
+
+    //Next recorded move, or a NOOP once the recording runs out
+    PlayerMoveType nextMove()
+    {
+        PlayerMoveType out = PlayerMoveType();
+        if(_noops)
+        {
+            _noops--;
+            return out;
+        }
+
+        if(_ended) return out;
+
+        unsigned char tag = _in.getByte();
+        if(tag == REPLAY_END || !_in.good())
+        {
+            _ended = true;
+            return out;
+        }
+
+        if((tag & 0x07) == REPLAY_NOOP_RUN)
+        {
+            _noops = _in.getVarint();
+            return nextMove();
+        }
+
+        replayRead(_in, tag, out);
+        return out;
+    }
+};
+
+#endif
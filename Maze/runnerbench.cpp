@@ -0,0 +1,160 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+
+#include "Mazes/Advanced/advancedcomponents.h"
+
+using namespace std;
+
+//Compares the virtual MazeRunner against the one bound to the Advanced
+//components at compile time. Both play the same game with simple built in
+//players, so the difference is what the runner spends dispatching calls
+
+//Walks the maze turning right whenever it can, cheap enough that the
+//runner's own work dominates
+class WallFollower : public AttributePlayer
+{
+    unsigned char _color[3] = {255, 255, 255};
+    unsigned int _facing = 0;
+
+public:
+    PlayerAttributes getAttributes(unsigned int points)
+    {
+        PlayerAttributes out = PlayerAttributes();
+        out.speed = points;
+        return out;
+    }
+
+    std::string playerName() {return "Wall Follower";}
+    unsigned char* playerColor() {return _color;}
+
+    AdvancedPlayerMove move(const AdvancedMapTile* surroundings,
+                            const uint& area_width, const uint& area_height,
+                            const uint& loc_x, const uint& loc_y)
+    {
+        static const AdvancedMapTile::Direction order[4] = {
+            AdvancedMapTile::Direction::NORTH, AdvancedMapTile::Direction::EAST,
+            AdvancedMapTile::Direction::SOUTH, AdvancedMapTile::Direction::WEST};
+
+        unsigned char exits = surroundings[loc_y*area_width + loc_x].exits;
+        for(unsigned int turn = 1; turn < 5; turn++)
+        {
+            unsigned int dir = (_facing + turn + 2) % 4;
+            if(exits & (unsigned char)order[dir])
+            {
+                _facing = dir;
+                return AdvancedPlayerMove(order[dir]);
+            }
+        }
+        return AdvancedPlayerMove();
+    }
+};
+
+typedef chrono::steady_clock benchClock;
+
+static double seconds(benchClock::time_point start)
+{
+    return chrono::duration<double>(benchClock::now() - start).count();
+}
+
+//Rule checks as the tick loop makes them, once through the interface and
+//once on the concrete class
+template<class Rules>
+__attribute__((noinline)) unsigned long long checkRules(Rules* rules, const vector<AdvancedPlayerData>& players,
+                                                        const maze<AdvancedMapTile>& m, unsigned int rounds)
+{
+    unsigned long long due = 0;
+    for(unsigned int r=0; r<rounds; r++)
+    {
+        for(const AdvancedPlayerData& p : players)
+        {
+            if(!rules->playerIsDone(p, m) && rules->playerGetsTurn(p, m))
+                due++;
+        }
+    }
+    return due;
+}
+
+template<class Runner>
+__attribute__((noinline)) double playTicks(Runner& m, unsigned int ticks, unsigned long long& checksum)
+{
+    benchClock::time_point start = benchClock::now();
+    for(unsigned int t=0; t<ticks && m.tickGame(); t++);
+    double out = seconds(start);
+
+    checksum = m.currentTurn();
+    for(auto p : m.getPlayerData())
+        checksum = checksum*31 + p.data.x*7 + p.data.y;
+    return out;
+}
+
+template<class Runner>
+double benchRunner(ostream& results, const char* name, unsigned int size, unsigned int players,
+                   unsigned int ticks, unsigned long long& checksum)
+{
+    AdvancedGenerator gen(size, size, 10);
+    AdvancedMover mover;
+    AdvancedPartitioner part;
+    AdvancedRules rules;
+    Runner m(&gen, &part, &mover, &rules, ticks*2, 1);
+
+    vector<WallFollower> followers(players);
+    for(WallFollower& f : followers)
+        m.addPlayer(&f);
+    m.setup();
+
+    double elapsed = playTicks(m, ticks, checksum);
+    results << name << ": " << elapsed/ticks*1e9 << " ns/tick, "
+            << elapsed/ticks/players*1e9 << " ns/player tick" << endl;
+
+    for(WallFollower& f : followers)
+        m.removePlayer(&f);
+    return elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int size = argc > 1 ? stoul(argv[1]) : 200;
+    unsigned int players = argc > 2 ? stoul(argv[2]) : 32;
+    unsigned int ticks = argc > 3 ? stoul(argv[3]) : 20000;
+
+    //Keep the runners' progress messages out of the results
+    ostream results(cout.rdbuf());
+    cout.rdbuf(nullptr);
+    cerr.rdbuf(nullptr);
+
+    results << size << "x" << size << " maze, " << players << " players, " << ticks << " ticks" << endl;
+
+    AdvancedRules rules;
+    RuleEnforcer<AttributePlayer, AdvancedPlayerData, AdvancedMapTile>* base = &rules;
+    maze<AdvancedMapTile> m;
+    m.exit = point{size, size};
+    //Some players mid move so the turn check goes both ways
+    vector<AdvancedPlayerData> data(players);
+    for(unsigned int i=0; i<players; i++)
+        data[i].ticksLeftForCurrentMove = i%3;
+    unsigned int rounds = 200000;
+
+    benchClock::time_point start = benchClock::now();
+    unsigned long long a = checkRules(base, data, m, rounds);
+    double virtualChecks = seconds(start);
+
+    start = benchClock::now();
+    unsigned long long b = checkRules(&rules, data, m, rounds);
+    double staticChecks = seconds(start);
+
+    results << "rule checks, virtual: " << virtualChecks/rounds/players*1e9 << " ns/player"
+            << ", static: " << staticChecks/rounds/players*1e9 << " ns/player" << endl;
+
+    unsigned long long virtualSum, staticSum;
+    double v = benchRunner<AdvancedRunner>(results, "virtual runner", size, players, ticks, virtualSum);
+    double s = benchRunner<StaticAdvancedRunner>(results, "static runner", size, players, ticks, staticSum);
+    results << "static runner takes " << s/v*100 << "% of the virtual runner's time" << endl;
+
+    if(a != b || virtualSum != staticSum)
+    {
+        results << "Runners disagree on the game" << endl;
+        return 1;
+    }
+    return 0;
+}
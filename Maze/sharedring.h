@@ -0,0 +1,160 @@
+#ifndef _SHARED_RING_H
+#define _SHARED_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+//Single producer, single consumer byte queue living in memory shared
+//between two processes
+//Both sides spin briefly when the ring is empty or full and then sleep on
+//a futex, so a busy pair of processes never makes a syscall per message.
+//Sleeps wake up every so often to ask whether the other side is still
+//alive, so a crashed peer turns into a failed read or write instead of
+//a hang
+class SharedRing
+{
+    struct Header
+    {
+        std::atomic<uint32_t> head;         //Bytes ever written, wrapping
+        std::atomic<uint32_t> tail;         //Bytes ever read, wrapping
+        std::atomic<uint32_t> readerWaiting;
+        std::atomic<uint32_t> writerWaiting;
+    };
+
+    static const unsigned int SPINS = 2000;
+
+    //Spinning only helps when the other side is running on another CPU
+    static unsigned int _spins()
+    {
+        static const unsigned int spins = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? SPINS : 0;
+        return spins;
+    }
+    static const long SLEEP_NS = 50*1000*1000;
+
+    Header* _header = nullptr;
+    unsigned char* _data = nullptr;
+    uint32_t _capacity = 0;
+
+    static void _futexWait(std::atomic<uint32_t>* word, uint32_t expected)
+    {
+        timespec timeout = {0, SLEEP_NS};
+        syscall(SYS_futex, (uint32_t*)word, FUTEX_WAIT, expected, &timeout, nullptr, 0);
+    }
+
+    static void _futexWake(std::atomic<uint32_t>* word)
+    {
+        syscall(SYS_futex, (uint32_t*)word, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+    }
+
+    //Waits until word no longer holds value
+    //Returns false if the peer died first
+    static bool _waitChange(std::atomic<uint32_t>* word, uint32_t value, std::atomic<uint32_t>* waiting,
+                            const std::function<bool()>& peerAlive)
+    {
+        for(unsigned int i=0; i<_spins(); i++)
+            if(word->load(std::memory_order_acquire) != value) return true;
+
+        while(true)
+        {
+            waiting->store(1);
+            if(word->load() != value) break;
+
+            _futexWait(word, value);
+            if(word->load(std::memory_order_acquire) != value) break;
+            if(peerAlive && !peerAlive())
+            {
+                waiting->store(0);
+                return false;
+            }
+        }
+        waiting->store(0);
+        return true;
+    }
+
+public:
+    //Capacity has to be a power of two
+    static size_t bytesNeeded(uint32_t capacity) {return sizeof(Header) + capacity;}
+
+    SharedRing(){}
+
+    //Uses bytesNeeded(capacity) bytes at memory
+    //Exactly one side should pass initialize as true, before the other side uses the ring
+    SharedRing(void* memory, uint32_t capacity, bool initialize) :
+        _header((Header*)memory), _data((unsigned char*)memory + sizeof(Header)), _capacity(capacity)
+    {
+        if(initialize)
+        {
+            new (&_header->head) std::atomic<uint32_t>(0);
+            new (&_header->tail) std::atomic<uint32_t>(0);
+            new (&_header->readerWaiting) std::atomic<uint32_t>(0);
+            new (&_header->writerWaiting) std::atomic<uint32_t>(0);
+        }
+    }
+
+    bool write(const void* data, size_t len, const std::function<bool()>& peerAlive = nullptr)
+    {
+        const unsigned char* in = (const unsigned char*)data;
+        uint32_t head = _header->head.load(std::memory_order_relaxed);
+        while(len)
+        {
+            uint32_t tail = _header->tail.load(std::memory_order_acquire);
+            if(head - tail == _capacity)
+            {
+                if(!_waitChange(&_header->tail, tail, &_header->writerWaiting, peerAlive))
+                    return false;
+                continue;
+            }
+
+            //Copy as much as fits before the end of the buffer
+            uint32_t offset = head & (_capacity-1);
+            size_t count = std::min<size_t>(len, std::min(_capacity - (head - tail), _capacity - offset));
+            memcpy(_data + offset, in, count);
+            in += count;
+            len -= count;
+            head += count;
+
+            _header->head.store(head);
+            if(_header->readerWaiting.load())
+                _futexWake(&_header->head);
+        }
+        return true;
+    }
+
+    bool read(void* out, size_t len, const std::function<bool()>& peerAlive = nullptr)
+    {
+        unsigned char* to = (unsigned char*)out;
+        uint32_t tail = _header->tail.load(std::memory_order_relaxed);
+        while(len)
+        {
+            uint32_t head = _header->head.load(std::memory_order_acquire);
+            if(head == tail)
+            {
+                if(!_waitChange(&_header->head, head, &_header->readerWaiting, peerAlive))
+                    return false;
+                continue;
+            }
+
+            uint32_t offset = tail & (_capacity-1);
+            size_t count = std::min<size_t>(len, std::min(head - tail, _capacity - offset));
+            memcpy(to, _data + offset, count);
+            to += count;
+            len -= count;
+            tail += count;
+
+            _header->tail.store(tail);
+            if(_header->writerWaiting.load())
+                _futexWake(&_header->tail);
+        }
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,307 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <unistd.h>
+
+#include "playerloader.h"
+#include "workerpool.h"
+#include "Mazes/Advanced/advancedcomponents.h"
+
+using namespace std;
+
+//Headless tournament driver
+//Plays every combination of seed, maze size and cycle percentage
+//with all the players in a directory, several games at a time, and
+//writes one CSV row per player per game plus a JSON summary per player
+
+struct GameSpec
+{
+    unsigned int seed;
+    unsigned int width, height;
+    unsigned int cycles;
+};
+
+struct GameResult
+{
+    GameSpec spec;
+    double setupSeconds = 0;
+    double runSeconds = 0;
+    unsigned int turns = 0;
+    vector<string> names;
+    vector<int> finishTurns;
+    vector<MoveStats> moveStats;
+};
+
+struct PlayerSummary
+{
+    unsigned int games = 0;
+    unsigned int wins = 0;
+    unsigned int finished = 0;
+    double finishTurnSum = 0;
+};
+
+//Streambuf which drops everything written to it
+//Games print progress to cout and cerr, which would interleave badly
+//when many of them run at once
+class NullBuffer : public streambuf
+{
+protected:
+    int overflow(int c){return c;}
+};
+
+static void usage(const char* name)
+{
+    cerr << "Usage: " << name << " [options]" << endl
+         << "  -s FIRST-LAST  Seeds to play (default 1-10)" << endl
+         << "  -m WxH,...     Maze sizes (default 100x100)" << endl
+         << "  -c N,...       Cycle percentages (default 10)" << endl
+         << "  -p DIR         Player directory (default ./Players)" << endl
+         << "  -j N           Games to run at once (default one per core)" << endl
+         << "  -t MS          Time a player may take for one move" << endl
+         << "  -T MS          CPU time a player may spend on moves over a game" << endl
+         << "  -i             Run each player in a process of its own" << endl
+         << "  -M MB          Memory limit for each isolated player" << endl
+         << "  -o FILE        Per game CSV output (default tournament.csv)" << endl
+         << "  -J FILE        Per player JSON summary (default tournament.json)" << endl;
+}
+
+static vector<string> split(const string& s, char delim)
+{
+    vector<string> out;
+    stringstream ss(s);
+    string item;
+    while(getline(ss, item, delim))
+        if(item.size()) out.push_back(item);
+    return out;
+}
+
+static string jsonEscape(const string& s)
+{
+    string out;
+    for(char c : s)
+    {
+        if(c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+static string csvEscape(const string& s)
+{
+    if(s.find_first_of(",\"") == string::npos) return s;
+
+    string out = "\"";
+    for(char c : s)
+    {
+        if(c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+static GameResult playGame(const GameSpec& spec, const string& playerDir, const MoveBudget& budget,
+                           const IsolationSettings* isolation)
+{
+    typedef chrono::steady_clock clock;
+
+    GameResult out;
+    out.spec = spec;
+
+    AdvancedGenerator mazeGen(spec.width, spec.height, spec.cycles);
+    AdvancedMover playerMove;
+    AdvancedPartitioner part;
+    AdvancedRules rules;
+    StaticAdvancedRunner m(&mazeGen, &part, &playerMove, &rules, spec.width*spec.height*20, spec.seed);
+    m.useEventScheduler(true);
+    m.setMoveBudget(budget);
+
+    PlayerLoader<AttributePlayer> g(&m);
+    if(isolation)
+        g.isolatePlayers(*isolation);
+    g.loadPlayers(playerDir);
+
+    auto start = clock::now();
+    m.setup();
+    auto setupDone = clock::now();
+
+    while(m.tickGame());
+    auto end = clock::now();
+
+    out.setupSeconds = chrono::duration<double>(setupDone - start).count();
+    out.runSeconds = chrono::duration<double>(end - setupDone).count();
+    out.turns = m.currentTurn();
+
+    for(unsigned int i=0; i<m.playerSlots(); i++)
+    {
+        if(m.slotPlayer(i) == nullptr) continue;
+
+        out.names.push_back(m.slotName(i));
+        out.finishTurns.push_back(m.finishTurn(i));
+        out.moveStats.push_back(m.moveStats(i));
+    }
+
+    return out;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int firstSeed = 1, lastSeed = 10;
+    vector<pair<unsigned int, unsigned int>> sizes;
+    vector<unsigned int> cycles;
+    string playerDir = "./Players";
+    string csvPath = "tournament.csv";
+    string jsonPath = "tournament.json";
+    unsigned int jobs = thread::hardware_concurrency();
+    MoveBudget budget;
+    bool isolated = false;
+    IsolationSettings isolation;
+
+    int opt;
+    while((opt = getopt(argc, argv, "s:m:c:p:j:t:T:iM:o:J:h")) != -1)
+    {
+        switch(opt)
+        {
+            case 's':
+            {
+                vector<string> range = split(optarg, '-');
+                if(range.empty()) {usage(argv[0]); return 1;}
+                firstSeed = stoul(range[0]);
+                lastSeed = range.size() > 1 ? stoul(range[1]) : firstSeed;
+            }
+            break;
+            case 'm':
+                for(const string& size : split(optarg, ','))
+                {
+                    vector<string> dims = split(size, 'x');
+                    if(dims.size() != 2) {usage(argv[0]); return 1;}
+                    sizes.push_back(make_pair(stoul(dims[0]), stoul(dims[1])));
+                }
+            break;
+            case 'c':
+                for(const string& c : split(optarg, ','))
+                    cycles.push_back(stoul(c));
+            break;
+            case 'p': playerDir = optarg; break;
+            case 'j': jobs = stoul(optarg); break;
+            case 't': budget.callSeconds = stod(optarg)/1000; break;
+            case 'T': budget.gameSeconds = stod(optarg)/1000; break;
+            case 'i': isolated = true; break;
+            case 'M': isolation.memoryLimitMB = stoul(optarg); break;
+            case 'o': csvPath = optarg; break;
+            case 'J': jsonPath = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+
+    if(sizes.empty()) sizes.push_back(make_pair(100, 100));
+    if(cycles.empty()) cycles.push_back(10);
+    if(jobs == 0) jobs = 1;
+
+    //Seed 0 means "use the clock" to the runner, which would not be reproducible
+    if(firstSeed == 0) firstSeed = 1;
+
+    vector<GameSpec> specs;
+    for(unsigned int seed = firstSeed; seed <= lastSeed; seed++)
+        for(const auto& size : sizes)
+            for(unsigned int c : cycles)
+                specs.push_back(GameSpec{seed, size.first, size.second, c});
+
+    ostream progress(cerr.rdbuf());
+    progress << "Playing " << specs.size() << " games, " << jobs << " at a time" << endl;
+
+    NullBuffer discard;
+    streambuf* coutBuf = cout.rdbuf(&discard);
+    streambuf* cerrBuf = cerr.rdbuf(&discard);
+
+    auto start = chrono::steady_clock::now();
+    vector<GameResult> results(specs.size());
+    mutex progressLock;
+    unsigned int finished = 0;
+    {
+        WorkerPool pool(jobs);
+        for(unsigned int i=0; i<specs.size(); i++)
+        {
+            pool.push([&, i]()
+            {
+                results[i] = playGame(specs[i], playerDir, budget, isolated ? &isolation : nullptr);
+
+                lock_guard<mutex> lock(progressLock);
+                progress << "\r" << ++finished << "/" << specs.size() << flush;
+            });
+        }
+        pool.wait();
+    }
+    double totalSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout.rdbuf(coutBuf);
+    cerr.rdbuf(cerrBuf);
+    progress << endl;
+
+    ofstream csv(csvPath);
+    csv << "seed,width,height,cycles,player,finish_turn,won,setup_ms,run_ms,timeouts,forfeits,move_p99_us,move_max_us" << endl;
+
+    map<string, PlayerSummary> summary;
+    for(const GameResult& r : results)
+    {
+        //Everyone tied for the earliest finish wins the game
+        int best = -1;
+        for(int t : r.finishTurns)
+            if(t >= 0 && (best < 0 || t < best)) best = t;
+
+        for(unsigned int i=0; i<r.names.size(); i++)
+        {
+            int turn = r.finishTurns[i];
+            bool won = turn >= 0 && turn == best;
+
+            csv << r.spec.seed << "," << r.spec.width << "," << r.spec.height << "," << r.spec.cycles << ","
+                << csvEscape(r.names[i]) << "," << turn << "," << (won ? 1 : 0) << ","
+                << r.setupSeconds*1000 << "," << r.runSeconds*1000 << ","
+                << r.moveStats[i].timeouts << "," << r.moveStats[i].forfeits << ","
+                << r.moveStats[i].latency.percentile(0.99) << "," << r.moveStats[i].latency.maxSeconds()*1e6 << endl;
+
+            PlayerSummary& s = summary[r.names[i]];
+            s.games++;
+            if(won) s.wins++;
+            if(turn >= 0)
+            {
+                s.finished++;
+                s.finishTurnSum += turn;
+            }
+        }
+    }
+
+    ofstream json(jsonPath);
+    json << "{" << endl
+         << "  \"games\": " << results.size() << "," << endl
+         << "  \"seconds\": " << totalSeconds << "," << endl
+         << "  \"players\": [" << endl;
+
+    unsigned int n = 0;
+    for(const auto& p : summary)
+    {
+        const PlayerSummary& s = p.second;
+        json << "    {\"name\": \"" << jsonEscape(p.first) << "\""
+             << ", \"games\": " << s.games
+             << ", \"wins\": " << s.wins
+             << ", \"win_rate\": " << (s.games ? (double)s.wins/s.games : 0)
+             << ", \"finished\": " << s.finished
+             << ", \"mean_finish_turn\": " << (s.finished ? s.finishTurnSum/s.finished : 0)
+             << "}" << (++n < summary.size() ? "," : "") << endl;
+    }
+    json << "  ]" << endl << "}" << endl;
+
+    cout << "Played " << results.size() << " games in " << totalSeconds << "s" << endl;
+    for(const auto& p : summary)
+    {
+        cout << p.first << ": " << p.second.wins << "/" << p.second.games << " wins, "
+             << p.second.finished << " finished" << endl;
+    }
+
+    return 0;
+}
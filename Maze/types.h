@@ -22,6 +22,7 @@ struct MapTile
         WEST = 8
     };
 
+    //Never filled in, the maze keeps track of players in its OccupancyIndex
     std::vector<unsigned int> players;
     unsigned int uid;
     bool isExit = false;
@@ -32,7 +33,7 @@ struct MapTile
         return o.exits != exits;
     }
 
-    bool getColor(unsigned char*& c)
+    bool getColor(unsigned char*& c) const
     {
         if(isExit)
         {
@@ -0,0 +1,87 @@
+#ifndef _WORKER_POOL_H
+#define _WORKER_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+//Fixed set of threads which run queued jobs in the order they were pushed
+//wait() blocks until every job pushed so far has finished
+class WorkerPool
+{
+    std::vector<std::thread> _threads;
+    std::queue<std::function<void()>> _jobs;
+    std::mutex _mut;
+    std::condition_variable _jobReady;
+    std::condition_variable _jobsDone;
+    unsigned int _unfinished = 0;
+    bool _stopping = false;
+
+    void _work()
+    {
+        while(true)
+        {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(_mut);
+                while(!_stopping && _jobs.empty())
+                    _jobReady.wait(lock);
+
+                if(_jobs.empty()) return;
+
+                job = std::move(_jobs.front());
+                _jobs.pop();
+            }
+
+            job();
+
+            std::unique_lock<std::mutex> lock(_mut);
+            if(--_unfinished == 0)
+                _jobsDone.notify_all();
+        }
+    }
+
+public:
+    WorkerPool(unsigned int threads)
+    {
+        if(threads == 0) threads = 1;
+        for(unsigned int i=0; i<threads; i++)
+            _threads.emplace_back(&WorkerPool::_work, this);
+    }
+
+    ~WorkerPool()
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mut);
+            _stopping = true;
+        }
+        _jobReady.notify_all();
+
+        for(auto& t : _threads)
+            t.join();
+    }
+
+    unsigned int size() const {return _threads.size();}
+
+    void push(std::function<void()> job)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mut);
+            _jobs.push(std::move(job));
+            _unfinished++;
+        }
+        _jobReady.notify_one();
+    }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(_mut);
+        while(_unfinished)
+            _jobsDone.wait(lock);
+    }
+};
+
+#endif
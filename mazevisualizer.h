@@ -30,8 +30,11 @@ class MazeVisualizer : public Widget
     std::unordered_map<unsigned int, std::unordered_map<unsigned int, color>> _paths;
     std::unordered_map<PlayerType*, point> _playerLocations;
 
-    void _drawCell(const unsigned int& x, const unsigned int& y, const Tile& tile);
-    void _drawCell(const unsigned int& x, const unsigned int& y, const Tile& tile, const color& rgb);
+    //Where we are in the maze's journal, so only changed cells are redrawn
+    typename MazeJournal<Tile>::Cursor _changes;
+
+    void _drawCell(const unsigned int& x, const unsigned int& y, unsigned char exits);
+    void _drawCell(const unsigned int& x, const unsigned int& y, unsigned char exits, const color& rgb);
     color _getColor(const unsigned int& x, const unsigned int& y);
     void _addColor(const unsigned int& x, const unsigned int& y, const color& rgb);
 
@@ -98,14 +101,14 @@ typename MazeVisualizer<PlayerType, PlayerDataType, Tile>::color MazeVisualizer<
 }
 
 template<class PlayerType, class PlayerDataType, class Tile>
-void MazeVisualizer<PlayerType, PlayerDataType, Tile>::_drawCell(const unsigned int& x, const unsigned int& y, const Tile& tile)
+void MazeVisualizer<PlayerType, PlayerDataType, Tile>::_drawCell(const unsigned int& x, const unsigned int& y, unsigned char exits)
 {
     color rgb = _getColor(x, y);
-    _drawCell(x, y, tile, rgb);
+    _drawCell(x, y, exits, rgb);
 }
 
 template<class PlayerType, class PlayerDataType, class Tile>
-void MazeVisualizer<PlayerType, PlayerDataType, Tile>::_drawCell(const unsigned int& x, const unsigned int& y, const Tile& tile, const color& rgb)
+void MazeVisualizer<PlayerType, PlayerDataType, Tile>::_drawCell(const unsigned int& x, const unsigned int& y, unsigned char exits, const color& rgb)
 {
     if(x < 0 || x >= _mwidth || y < 0 || y >= _mheight) return;
     unsigned int y_ = _mheight-y-1;
@@ -127,10 +130,10 @@ void MazeVisualizer<PlayerType, PlayerDataType, Tile>::_drawCell(const unsigned
     //cerr << "Row offset " << (y_<_exH?(y_+1)*_buffW:_exH*_buffW) << endl;
     //cerr << "Total offset " << rowBytes*(y_+1) + (y_<_exH?(y_+1)*_buffW*3:_exH*_buffW*3) - _buffW*3 + skipBytes << endl;
 
-    bool north = ((tile.exits & (unsigned char)MapTile::Direction::NORTH) == 0);
-    bool south = ((tile.exits & (unsigned char)MapTile::Direction::SOUTH) == 0);
-    bool east = ((tile.exits & (unsigned char)MapTile::Direction::EAST) == 0);
-    bool west = ((tile.exits & (unsigned char)MapTile::Direction::WEST) == 0);
+    bool north = ((exits & (unsigned char)MapTile::Direction::NORTH) == 0);
+    bool south = ((exits & (unsigned char)MapTile::Direction::SOUTH) == 0);
+    bool east = ((exits & (unsigned char)MapTile::Direction::EAST) == 0);
+    bool west = ((exits & (unsigned char)MapTile::Direction::WEST) == 0);
 
     //cerr << north << " : " << south << " : " << east << " : " << west << endl;
 
@@ -179,24 +182,35 @@ void MazeVisualizer<PlayerType, PlayerDataType, Tile>::draw(const DrawingCanvas*
         return;
     }
 
-    //Check if any player didn't move, and the tile they were on changed
-    //Then we need to redraw the whole maze
-    std::unordered_map<PlayerType*, PlayerDataType>* players = _maze->getPlayerData();
-    for(const auto& p : *players)
+    //A new maze, or one put back from a snapshot, has to be drawn from scratch
+    //Otherwise only the cells changed since the last draw are
+    if(!maze.journal.valid(_changes))
+    {
+        delete[] _buffer;
+        _buffer = nullptr;
+        _changes = maze.journal.subscribe();
+    }
+    maze.journal.read(_changes, [this](const MazeChange<Tile>& c)
+    {
+        if(_buffer)
+            _drawCell(c.tile % _mwidth, c.tile / _mwidth, c.after.exits);
+    });
+
+    //Cells players left need their colour back
+    PlayerDataView<PlayerType, PlayerDataType> players = _maze->getPlayerData();
+    for(const auto& p : players)
     {
-        auto& pLoc = _playerLocations[p.first];
-        auto pTile = maze.at(pLoc.x, pLoc.y);
-        auto mTile = maze.at(p.second.x, p.second.y);
-        if(pLoc.x != p.second.x || pLoc.y != p.second.y)
+        auto& pLoc = _playerLocations[p.player];
+        if(pLoc.x != p.data.x || pLoc.y != p.data.y)
         {
             if(_buffer)
             {
-                _drawCell(pLoc.x, pLoc.y, pTile);
+                _drawCell(pLoc.x, pLoc.y, maze.exits(pLoc.x, pLoc.y));
             }
-            pLoc = point{p.second.x, p.second.y};
+            pLoc = point{p.data.x, p.data.y};
 
             //Only add player colors when they move
-            unsigned char* pcolor = p.first->playerColor();
+            unsigned char* pcolor = p.player->playerColor();
 
             unsigned char r = pcolor[0]/3;
             unsigned char g = pcolor[1]/3;
@@ -204,14 +218,6 @@ void MazeVisualizer<PlayerType, PlayerDataType, Tile>::draw(const DrawingCanvas*
 
             _addColor(pLoc.x, pLoc.y, color{r, g, b});
         }
-        else if(pTile != mTile)
-        {
-            if(_buffer)
-            {
-                delete[] _buffer;
-                _buffer = nullptr;
-            }
-        }
     }
 
     if(_buffer == nullptr)
@@ -242,14 +248,7 @@ void MazeVisualizer<PlayerType, PlayerDataType, Tile>::draw(const DrawingCanvas*
         {
             _buffer = new unsigned char[_bufferSize];
 
-            auto iter = maze.begin();
-            for(unsigned int i=0; i<_mheight; i++)
-            {
-                for(unsigned int j=0; j<_mwidth; j++)
-                {
-                    _drawCell(j, i, *(iter++));
-                }
-            }
+            maze.forEachTile([this, &maze](unsigned int x, unsigned int y){_drawCell(x, y, maze.exits(x, y));});
         }
         
         //cerr << "Maze drawn" << endl;
@@ -258,17 +257,17 @@ void MazeVisualizer<PlayerType, PlayerDataType, Tile>::draw(const DrawingCanvas*
     if(_buffer == nullptr) return;
 
     //Draw players
-    for(auto p : *players)
+    for(const auto& p : players)
     {
-        //cout << "Draw player " << p.first << " : " << p.second << endl;
-        unsigned char* pcolor = p.first->playerColor();
-        point ploc = point{p.second.x, p.second.y};
+        //cout << "Draw player " << p.player << " : " << p.data << endl;
+        unsigned char* pcolor = p.player->playerColor();
+        point ploc = point{p.data.x, p.data.y};
 
-        _drawCell(ploc.x, ploc.y, maze.at(point{ploc.x, ploc.y}), color{pcolor[0], pcolor[1], pcolor[2]});
+        _drawCell(ploc.x, ploc.y, maze.exits(ploc), color{pcolor[0], pcolor[1], pcolor[2]});
     }
 
     //Draw exit
-    _drawCell(maze.exit.x, maze.exit.y, maze.at(maze.exit));
+    _drawCell(maze.exit.x, maze.exit.y, maze.exits(maze.exit));
 
 
     if(_buffer != nullptr)